@@ -417,6 +417,9 @@ namespace wallet_types
 
         /* The hashrate (based on the last block the daemon has synced) */
         uint64_t lastKnownHashrate;
+
+        /* The amount of blocks per second the wallet is syncing */
+        double syncSpeed;
     };
 
     /* A structure just used to display locked balance, due to change from
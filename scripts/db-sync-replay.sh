@@ -0,0 +1,70 @@
+#!/bin/bash
+# Rebuilds the node database from an existing blocks.bin, the same way the
+# daemon does on first start after the DB was removed, and reports how long
+# it took along with the database statistics logged on shutdown: the on disk
+# size of each column family and the read amplification of the replay.
+#
+# Run it once per set of database options to compare them, for example:
+#
+#   ./db-sync-replay.sh ./mevacoind ~/.mevacoin --db-compression=none --db-bottommost-compression=none
+#   ./db-sync-replay.sh ./mevacoind ~/.mevacoin --db-compression=lz4 --db-bottommost-compression=zstd
+#
+# or, to see whether keeping index and filter blocks in the read cache pays
+# off at a given cache size, compare the read amplification of:
+#
+#   ./db-sync-replay.sh ./mevacoind ~/.mevacoin --db-read-buffer-size=10
+#   ./db-sync-replay.sh ./mevacoind ~/.mevacoin --db-read-buffer-size=10 --db-cache-index-filters
+#
+# The source data directory is only read from. Set P2P_PORT and RPC_PORT if
+# another node is running on this machine.
+
+if [ "$#" -lt 2 ]; then
+    echo "Usage: $0 <path to mevacoind> <source data dir> [extra daemon options]"
+    exit 1
+fi
+
+daemon=$1
+source=$2
+shift 2
+
+replay=$(mktemp -d)
+log="$replay/replay.log"
+p2pPort=${P2P_PORT:-32897}
+rpcPort=${RPC_PORT:-32898}
+
+trap 'rm -rf "$replay"' EXIT
+
+cp "$source/blocks.bin" "$source/blockindexes.bin" "$replay/" || exit 1
+
+start=$(date +%s)
+
+# Don't talk to the network, so only the blocks we copied are imported
+"$daemon" --data-dir "$replay" --log-file "$log" --log-level 3 --no-console \
+    --add-exclusive-node 127.0.0.1:1 --p2p-bind-port $p2pPort --rpc-bind-port $rpcPort \
+    --db-statistics "$@" > /dev/null &
+
+pid=$!
+
+until grep -q "Core initialized OK" "$log" 2> /dev/null; do
+    if ! kill -0 $pid 2> /dev/null; then
+        echo "Daemon exited before the import finished, see below"
+        cat "$log"
+        exit 1
+    fi
+
+    sleep 1
+done
+
+end=$(date +%s)
+
+# The signal handler that shuts the DB down cleanly is installed just before this
+until grep -q "Starting p2p net loop" "$log"; do
+    sleep 1
+done
+
+kill -INT $pid
+wait $pid
+
+echo "Replayed blocks.bin in $((end - start)) seconds with options: $*"
+grep "DB statistics" "$log" | sed 's/.*DB statistics: //'
+echo "DB directory size: $(du -sh "$replay/DB" | cut -f1)"
@@ -323,6 +323,11 @@ namespace common
         uint64_t suffixSize() const;
         void resizeSuffix(uint64_t newSuffixSize);
 
+        /* Unlike resizeSuffix(), this grows the file in place rather than
+           copying it, so it isn't atomic. If it is interrupted, the suffix
+           may end with some or all of the new data missing or garbled */
+        void appendToSuffix(const void *data, uint64_t dataSize);
+
         void rename(const std::string &newPath, std::error_code &ec);
         void rename(const std::string &newPath);
 
@@ -841,6 +846,24 @@ namespace common
         }
     }
 
+    template <class T>
+    void FileMappedVector<T>::appendToSuffix(const void *data, uint64_t dataSize)
+    {
+        assert(isOpened());
+
+        const uint64_t oldSuffixSize = suffixSize();
+
+        m_file.resize(m_file.size() + dataSize);
+        m_suffixSize = oldSuffixSize + dataSize;
+
+        std::copy(static_cast<const uint8_t *>(data), static_cast<const uint8_t *>(data) + dataSize, suffixPtr() + oldSuffixSize);
+
+        if (m_autoFlush)
+        {
+            flush();
+        }
+    }
+
     template <class T>
     void FileMappedVector<T>::rename(const std::string &newPath, std::error_code &ec)
     {
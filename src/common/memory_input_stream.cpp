@@ -20,6 +20,11 @@ namespace common
         return position == bufferSize;
     }
 
+    uint64_t MemoryInputStream::getPosition() const
+    {
+        return position;
+    }
+
     uint64_t MemoryInputStream::readSome(void *data, uint64_t size)
     {
         assert(position <= bufferSize);
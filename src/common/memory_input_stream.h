@@ -17,6 +17,7 @@ namespace common
     public:
         MemoryInputStream(const void *buffer, uint64_t bufferSize);
         bool endOfStream() const;
+        uint64_t getPosition() const;
 
         // IInputStream
         virtual uint64_t readSome(void *data, uint64_t size) override;
@@ -0,0 +1,174 @@
+// Copyright (c) 2019, The Kryptokrona Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cassert>
+#include <deque>
+#include <iterator>
+#include <set>
+
+namespace common
+{
+
+    /* Keeps the median of a set of values that changes one value at a time,
+       for example a sliding window of block sizes, so the median doesn't have
+       to be found by sorting every value again. Inserting and erasing are
+       O(log n), the median is O(1), and it matches medianValue() in math.h */
+    template <typename T>
+    class RollingMedian
+    {
+    public:
+        void insert(const T &value)
+        {
+            if (m_lower.empty() || !(*m_lower.rbegin() < value))
+            {
+                m_lower.insert(value);
+            }
+            else
+            {
+                m_upper.insert(value);
+            }
+
+            rebalance();
+        }
+
+        /* The value must have been inserted before */
+        void erase(const T &value)
+        {
+            if (const auto it = m_lower.find(value); it != m_lower.end())
+            {
+                m_lower.erase(it);
+            }
+            else
+            {
+                const auto upper = m_upper.find(value);
+
+                assert(upper != m_upper.end());
+
+                m_upper.erase(upper);
+            }
+
+            rebalance();
+        }
+
+        T median() const
+        {
+            if (m_lower.empty())
+            {
+                return T();
+            }
+
+            if (m_lower.size() > m_upper.size())
+            {
+                return *m_lower.rbegin();
+            }
+
+            return (*m_lower.rbegin() + *m_upper.begin()) / 2;
+        }
+
+        size_t size() const
+        {
+            return m_lower.size() + m_upper.size();
+        }
+
+        void clear()
+        {
+            m_lower.clear();
+            m_upper.clear();
+        }
+
+    private:
+        /* Keeps every value in m_lower <= every value in m_upper, with
+           m_lower holding the extra value if there are an odd number */
+        void rebalance()
+        {
+            if (m_lower.size() > m_upper.size() + 1)
+            {
+                const auto it = std::prev(m_lower.end());
+                m_upper.insert(*it);
+                m_lower.erase(it);
+            }
+            else if (m_upper.size() > m_lower.size())
+            {
+                const auto it = m_upper.begin();
+                m_lower.insert(*it);
+                m_upper.erase(it);
+            }
+        }
+
+        /* The smaller half of the values */
+        std::multiset<T> m_lower;
+
+        /* The larger half of the values */
+        std::multiset<T> m_upper;
+    };
+
+    /* The median of the last values pushed, up to a maximum number of them */
+    template <typename T>
+    class SlidingWindowMedian
+    {
+    public:
+        /* Replaces the window with the given values, oldest first */
+        template <typename Iterator>
+        void assign(Iterator begin, Iterator end)
+        {
+            clear();
+
+            for (auto it = begin; it != end; ++it)
+            {
+                m_values.push_back(*it);
+                m_median.insert(*it);
+            }
+        }
+
+        /* Adds a value, dropping the oldest ones if there are then more than
+           maxSize */
+        void push(const T &value, size_t maxSize)
+        {
+            m_values.push_back(value);
+            m_median.insert(value);
+
+            trim(maxSize);
+        }
+
+        /* Drops the oldest values until there are at most maxSize */
+        void trim(size_t maxSize)
+        {
+            while (m_values.size() > maxSize)
+            {
+                m_median.erase(m_values.front());
+                m_values.pop_front();
+            }
+        }
+
+        T median() const
+        {
+            return m_median.median();
+        }
+
+        size_t size() const
+        {
+            return m_values.size();
+        }
+
+        /* Oldest first */
+        const std::deque<T> &values() const
+        {
+            return m_values;
+        }
+
+        void clear()
+        {
+            m_values.clear();
+            m_median.clear();
+        }
+
+    private:
+        std::deque<T> m_values;
+
+        RollingMedian<T> m_median;
+    };
+
+}
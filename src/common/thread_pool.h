@@ -0,0 +1,126 @@
+// Copyright (c) 2019, The Kryptokrona Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace common
+{
+
+    /* A fixed size pool of long lived worker threads. Jobs are executed in
+       the order they were added, and the result (or exception) of each job
+       is handed back through the returned future. */
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency()) : m_shouldStop(false)
+        {
+            /* hardware_concurrency() may return 0 if it can't be detected */
+            if (threadCount == 0)
+            {
+                threadCount = 1;
+            }
+
+            m_threads.reserve(threadCount);
+
+            for (size_t i = 0; i < threadCount; i++)
+            {
+                m_threads.emplace_back(&ThreadPool::workerLoop, this);
+            }
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_shouldStop = true;
+            }
+
+            m_haveJob.notify_all();
+
+            for (auto &thread : m_threads)
+            {
+                if (thread.joinable())
+                {
+                    thread.join();
+                }
+            }
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        template <typename Func>
+        auto addJob(Func &&job) -> std::future<decltype(job())>
+        {
+            using ResultType = decltype(job());
+
+            auto task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Func>(job));
+
+            std::future<ResultType> result = task->get_future();
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobs.emplace([task]
+                               { (*task)(); });
+            }
+
+            m_haveJob.notify_one();
+
+            return result;
+        }
+
+        size_t threadCount() const
+        {
+            return m_threads.size();
+        }
+
+    private:
+        void workerLoop()
+        {
+            while (true)
+            {
+                std::function<void()> job;
+
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+
+                    m_haveJob.wait(lock, [&]
+                                   { return m_shouldStop || !m_jobs.empty(); });
+
+                    /* Finish off any queued jobs before stopping, so nobody
+                       is left waiting on a future that will never be set */
+                    if (m_shouldStop && m_jobs.empty())
+                    {
+                        return;
+                    }
+
+                    job = std::move(m_jobs.front());
+                    m_jobs.pop();
+                }
+
+                job();
+            }
+        }
+
+        std::vector<std::thread> m_threads;
+
+        std::queue<std::function<void()>> m_jobs;
+
+        std::mutex m_mutex;
+
+        std::condition_variable m_haveJob;
+
+        bool m_shouldStop;
+    };
+
+}
@@ -233,6 +233,11 @@ namespace mevacoin
     const uint64_t BLOCKS_SYNCHRONIZING_DEFAULT_COUNT = 100;     // by default, blocks count in blocks downloading
     const size_t COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT = 1000;
 
+    // Details of main chain blocks at least this deep are kept in memory for the RPC,
+    // as only a reorg deeper than this could change them
+    const uint32_t BLOCK_DETAILS_CACHE_MIN_DEPTH = 60;
+    const size_t BLOCK_DETAILS_CACHE_MAX_SIZE = 64 * 1024 * 1024; // 64 MB, roughly
+
 #ifdef USE_TESTNET
     const int P2P_DEFAULT_PORT = 17078;
     const int RPC_DEFAULT_PORT = 17079;
@@ -274,6 +279,12 @@ namespace mevacoin
     const uint64_t DATABASE_READ_BUFFER_MB_DEFAULT_SIZE = 10;
     const uint32_t DATABASE_DEFAULT_MAX_OPEN_FILES = 100;
     const uint16_t DATABASE_DEFAULT_BACKGROUND_THREADS_COUNT = 2;
+    /* lz4 for the upper levels and zstd for the bottommost one, or the best
+       this build of rocksdb supports */
+    const char DATABASE_DEFAULT_COMPRESSION[] = "auto";
+    const char DATABASE_DEFAULT_BOTTOMMOST_COMPRESSION[] = "auto";
+    const char DATABASE_DEFAULT_BLOCK_CACHE_TYPE[] = "lru";
+    const int DATABASE_DEFAULT_HIGH_PRIORITY_POOL_PERCENT = 20;
 
     const char LATEST_VERSION_URL[] = "https://github.com/mevacoin/mevacoin";
     const std::string LICENSE_URL = "https://github.com/mevacoin/mevacoin/blob/master/LICENSE";
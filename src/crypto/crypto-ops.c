@@ -2345,6 +2345,97 @@ void ge_double_scalarmult_precomp_vartime(ge_p2 *r, const unsigned char *a, cons
     }
 }
 
+/*
+Computes both points of a ring signature member in a single pass:
+L = a * A + b * B
+R = b * C + a * D
+where B is the Ed25519 base point and Di is the precomputed table of D.
+The sliding window recodings of a and b are shared between the two
+results, and the two doubling chains are interleaved in the same loop.
+*/
+
+void ge_double_scalarmult_ring_vartime(ge_p2 *L, ge_p2 *R, const unsigned char *a, const ge_p3 *A, const unsigned char *b, const ge_p3 *C, const ge_dsmp Di)
+{
+    signed char aslide[256];
+    signed char bslide[256];
+    ge_dsmp Ai; /* A, 3A, 5A, 7A, 9A, 11A, 13A, 15A */
+    ge_dsmp Ci; /* C, 3C, 5C, 7C, 9C, 11C, 13C, 15C */
+    ge_p1p1 t;
+    ge_p3 u;
+    int i;
+
+    slide(aslide, a);
+    slide(bslide, b);
+    ge_dsm_precomp(Ai, A);
+    ge_dsm_precomp(Ci, C);
+
+    ge_p2_0(L);
+    ge_p2_0(R);
+
+    for (i = 255; i >= 0; --i)
+    {
+        if (aslide[i] || bslide[i])
+            break;
+    }
+
+    for (; i >= 0; --i)
+    {
+        /* L = a * A + b * B */
+        ge_p2_dbl(&t, L);
+
+        if (aslide[i] > 0)
+        {
+            ge_p1p1_to_p3(&u, &t);
+            ge_add(&t, &u, &Ai[aslide[i] / 2]);
+        }
+        else if (aslide[i] < 0)
+        {
+            ge_p1p1_to_p3(&u, &t);
+            ge_sub(&t, &u, &Ai[(-aslide[i]) / 2]);
+        }
+
+        if (bslide[i] > 0)
+        {
+            ge_p1p1_to_p3(&u, &t);
+            ge_madd(&t, &u, &ge_Bi[bslide[i] / 2]);
+        }
+        else if (bslide[i] < 0)
+        {
+            ge_p1p1_to_p3(&u, &t);
+            ge_msub(&t, &u, &ge_Bi[(-bslide[i]) / 2]);
+        }
+
+        ge_p1p1_to_p2(L, &t);
+
+        /* R = b * C + a * D */
+        ge_p2_dbl(&t, R);
+
+        if (bslide[i] > 0)
+        {
+            ge_p1p1_to_p3(&u, &t);
+            ge_add(&t, &u, &Ci[bslide[i] / 2]);
+        }
+        else if (bslide[i] < 0)
+        {
+            ge_p1p1_to_p3(&u, &t);
+            ge_sub(&t, &u, &Ci[(-bslide[i]) / 2]);
+        }
+
+        if (aslide[i] > 0)
+        {
+            ge_p1p1_to_p3(&u, &t);
+            ge_add(&t, &u, &Di[aslide[i] / 2]);
+        }
+        else if (aslide[i] < 0)
+        {
+            ge_p1p1_to_p3(&u, &t);
+            ge_sub(&t, &u, &Di[(-aslide[i]) / 2]);
+        }
+
+        ge_p1p1_to_p2(R, &t);
+    }
+}
+
 int ge_check_subgroup_precomp_vartime(const ge_dsmp p)
 {
     ge_p3 s;
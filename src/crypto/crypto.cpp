@@ -392,21 +392,45 @@ namespace crypto
     std::tuple<bool, std::vector<Signature>> crypto_ops::generateRingSignatures(
         const Hash prefixHash,
         const KeyImage keyImage,
-        const std::vector<PublicKey> publicKeys,
+        const std::vector<PublicKey> &publicKeys,
         const crypto::SecretKey transactionSecretKey,
         uint64_t realOutput)
     {
         std::vector<Signature> signatures(publicKeys.size());
 
+        const bool success = generateRingSignatures(
+            prefixHash,
+            keyImage,
+            {publicKeys.data(), publicKeys.size()},
+            transactionSecretKey,
+            realOutput,
+            {signatures.data(), signatures.size()});
+
+        return {success, signatures};
+    }
+
+    bool crypto_ops::generateRingSignatures(
+        const Hash &prefixHash,
+        const KeyImage &keyImage,
+        const common::ArrayView<PublicKey> publicKeys,
+        const crypto::SecretKey &transactionSecretKey,
+        const uint64_t realOutput,
+        const common::ArrayRef<Signature> signatures)
+    {
+        if (signatures.getSize() != publicKeys.getSize() || realOutput >= publicKeys.getSize())
+        {
+            return false;
+        }
+
         ge_p3 image_unp;
         ge_dsmp image_pre;
         EllipticCurveScalar sum, k, h;
 
-        rs_comm *const buf = reinterpret_cast<rs_comm *>(alloca(rs_comm_size(publicKeys.size())));
+        rs_comm *const buf = reinterpret_cast<rs_comm *>(alloca(rs_comm_size(publicKeys.getSize())));
 
         if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char *>(&keyImage)) != 0)
         {
-            return {false, signatures};
+            return false;
         }
 
         ge_dsm_precomp(image_pre, &image_unp);
@@ -415,7 +439,7 @@ namespace crypto
 
         buf->h = prefixHash;
 
-        for (size_t i = 0; i < publicKeys.size(); i++)
+        for (size_t i = 0; i < publicKeys.getSize(); i++)
         {
             ge_p2 tmp2;
             ge_p3 tmp3;
@@ -436,7 +460,7 @@ namespace crypto
 
                 if (ge_frombytes_vartime(&tmp3, reinterpret_cast<const unsigned char *>(&publicKeys[i])) != 0)
                 {
-                    return {false, signatures};
+                    return false;
                 }
 
                 ge_double_scalarmult_base_vartime(
@@ -465,7 +489,7 @@ namespace crypto
             }
         }
 
-        hash_to_scalar(buf, rs_comm_size(publicKeys.size()), h);
+        hash_to_scalar(buf, rs_comm_size(publicKeys.getSize()), h);
 
         sc_sub(
             reinterpret_cast<unsigned char *>(&signatures[realOutput]),
@@ -478,15 +502,33 @@ namespace crypto
             reinterpret_cast<const unsigned char *>(&transactionSecretKey),
             reinterpret_cast<unsigned char *>(&k));
 
-        return {true, signatures};
+        return true;
+    }
+
+    bool crypto_ops::checkRingSignature(
+        const Hash &prefix_hash,
+        const KeyImage &image,
+        const std::vector<PublicKey> &pubs,
+        const std::vector<Signature> &signatures)
+    {
+        return checkRingSignature(
+            prefix_hash,
+            image,
+            {pubs.data(), pubs.size()},
+            {signatures.data(), signatures.size()});
     }
 
     bool crypto_ops::checkRingSignature(
         const Hash &prefix_hash,
         const KeyImage &image,
-        const std::vector<PublicKey> pubs,
-        const std::vector<Signature> signatures)
+        const common::ArrayView<PublicKey> pubs,
+        const common::ArrayView<Signature> signatures)
     {
+        /* Every ring member needs a signature, reading past the end otherwise */
+        if (signatures.getSize() < pubs.getSize())
+        {
+            return false;
+        }
 
         ge_p3 image_unp;
 
@@ -494,7 +536,7 @@ namespace crypto
 
         EllipticCurveScalar sum, h;
 
-        rs_comm *const buf = reinterpret_cast<rs_comm *>(alloca(rs_comm_size(pubs.size())));
+        rs_comm *const buf = reinterpret_cast<rs_comm *>(alloca(rs_comm_size(pubs.getSize())));
 
         if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char *>(&image)) != 0)
         {
@@ -512,7 +554,7 @@ namespace crypto
 
         buf->h = prefix_hash;
 
-        for (size_t i = 0; i < pubs.size(); i++)
+        for (size_t i = 0; i < pubs.getSize(); i++)
         {
             ge_p2 tmp2;
             ge_p3 tmp3;
@@ -552,7 +594,84 @@ namespace crypto
                 reinterpret_cast<const unsigned char *>(&signatures[i]));
         }
 
-        hash_to_scalar(buf, rs_comm_size(pubs.size()), h);
+        hash_to_scalar(buf, rs_comm_size(pubs.getSize()), h);
+
+        sc_sub(
+            reinterpret_cast<unsigned char *>(&h),
+            reinterpret_cast<unsigned char *>(&h),
+            reinterpret_cast<unsigned char *>(&sum));
+
+        return sc_isnonzero(reinterpret_cast<unsigned char *>(&h)) == 0;
+    }
+
+    bool crypto_ops::checkRingSignatureInterleaved(
+        const Hash &prefix_hash,
+        const KeyImage &image,
+        const common::ArrayView<PublicKey> pubs,
+        const common::ArrayView<Signature> signatures)
+    {
+        if (signatures.getSize() < pubs.getSize())
+        {
+            return false;
+        }
+
+        ge_p3 image_unp;
+
+        ge_dsmp image_pre;
+
+        EllipticCurveScalar sum, h;
+
+        rs_comm *const buf = reinterpret_cast<rs_comm *>(alloca(rs_comm_size(pubs.getSize())));
+
+        if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char *>(&image)) != 0)
+        {
+            return false;
+        }
+
+        ge_dsm_precomp(image_pre, &image_unp);
+
+        if (ge_check_subgroup_precomp_vartime(image_pre) != 0)
+        {
+            return false;
+        }
+
+        sc_0(reinterpret_cast<unsigned char *>(&sum));
+
+        buf->h = prefix_hash;
+
+        for (size_t i = 0; i < pubs.getSize(); i++)
+        {
+            ge_p2 a, b;
+            ge_p3 pub, hashedPub;
+
+            const unsigned char *c = reinterpret_cast<const unsigned char *>(&signatures[i]);
+            const unsigned char *r = c + 32;
+
+            if (sc_check(c) != 0 || sc_check(r) != 0)
+            {
+                return false;
+            }
+
+            if (ge_frombytes_vartime(&pub, reinterpret_cast<const unsigned char *>(&pubs[i])) != 0)
+            {
+                return false;
+            }
+
+            hash_to_ec(pubs[i], hashedPub);
+
+            /* a = c * P + r * G, b = r * Hp(P) + c * I */
+            ge_double_scalarmult_ring_vartime(&a, &b, c, &pub, r, &hashedPub, image_pre);
+
+            ge_tobytes(reinterpret_cast<unsigned char *>(&buf->ab[i].a), &a);
+            ge_tobytes(reinterpret_cast<unsigned char *>(&buf->ab[i].b), &b);
+
+            sc_add(
+                reinterpret_cast<unsigned char *>(&sum),
+                reinterpret_cast<unsigned char *>(&sum),
+                c);
+        }
+
+        hash_to_scalar(buf, rs_comm_size(pubs.getSize()), h);
 
         sc_sub(
             reinterpret_cast<unsigned char *>(&h),
@@ -14,6 +14,8 @@
 #include <type_traits>
 #include <vector>
 
+#include <common/array_ref.h>
+#include <common/array_view.h>
 #include <crypto_types.h>
 
 #include "hash.h"
@@ -81,15 +83,41 @@ namespace crypto
         static std::tuple<bool, std::vector<Signature>> generateRingSignatures(
             const Hash prefixHash,
             const KeyImage keyImage,
-            const std::vector<PublicKey> publicKeys,
+            const std::vector<PublicKey> &publicKeys,
             const crypto::SecretKey transactionSecretKey,
             uint64_t realOutput);
 
+        /* Writes the ring signatures directly into signatures, which must be
+           the same size as publicKeys */
+        static bool generateRingSignatures(
+            const Hash &prefixHash,
+            const KeyImage &keyImage,
+            const common::ArrayView<PublicKey> publicKeys,
+            const crypto::SecretKey &transactionSecretKey,
+            const uint64_t realOutput,
+            const common::ArrayRef<Signature> signatures);
+
+        static bool checkRingSignature(
+            const Hash &prefix_hash,
+            const KeyImage &image,
+            const std::vector<PublicKey> &pubs,
+            const std::vector<Signature> &signatures);
+
+        /* Verifies a ring signature without copying the ring or the signatures */
         static bool checkRingSignature(
             const Hash &prefix_hash,
             const KeyImage &image,
-            const std::vector<PublicKey> pubs,
-            const std::vector<Signature> signatures);
+            const common::ArrayView<PublicKey> pubs,
+            const common::ArrayView<Signature> signatures);
+
+        /* Gives the same result as checkRingSignature, but computes both points
+           of each ring member in a single interleaved pass, sharing the scalar
+           recoding between them */
+        static bool checkRingSignatureInterleaved(
+            const Hash &prefix_hash,
+            const KeyImage &image,
+            const common::ArrayView<PublicKey> pubs,
+            const common::ArrayView<Signature> signatures);
     };
 
     /* Generate a new key pair
@@ -15,6 +15,7 @@
 #include "mevacoin.h"
 #include "crypto_types.h"
 #include "common/string_tools.h"
+#include "common/thread_pool.h"
 #include "crypto/crypto.h"
 
 #define PERFORMANCE_ITERATIONS 1000
@@ -259,6 +260,284 @@ void benchmarkGenerateKeyDerivation()
     std::cout << "Time to perform generateKeyDerivation: " << timePerDerivation / 1000.0 << " ms" << std::endl;
 }
 
+/* Used instead of assert() for the ring signature checks, so they still run,
+   and fail the test, in builds with NDEBUG defined */
+[[noreturn]] void failCheck(const std::string &message)
+{
+    std::cout << "Error: " << message << std::endl;
+    exit(1);
+}
+
+struct RingSignatureInput
+{
+    Hash prefixHash;
+    KeyImage keyImage;
+    std::vector<PublicKey> publicKeys;
+    std::vector<Signature> signatures;
+};
+
+/* Builds the ring signed inputs of a synthetic block */
+std::vector<RingSignatureInput> generateRingSignatureInputs(const size_t inputCount, const size_t ringSize)
+{
+    std::vector<RingSignatureInput> inputs(inputCount);
+
+    for (auto &input : inputs)
+    {
+        PublicKey realPublicKey;
+        SecretKey realSecretKey;
+        generate_keys(realPublicKey, realSecretKey);
+
+        for (size_t i = 0; i < ringSize; i++)
+        {
+            PublicKey decoyKey;
+            SecretKey decoySecretKey;
+            generate_keys(decoyKey, decoySecretKey);
+
+            input.publicKeys.push_back(i == 0 ? realPublicKey : decoyKey);
+        }
+
+        generate_key_image(realPublicKey, realSecretKey, input.keyImage);
+
+        cn_fast_hash(input.publicKeys.data(), input.publicKeys.size() * sizeof(PublicKey), input.prefixHash);
+
+        const auto [success, signatures] = crypto_ops::generateRingSignatures(input.prefixHash, input.keyImage, input.publicKeys, realSecretKey, 0);
+
+        if (!success)
+        {
+            failCheck("generateRingSignatures failed for ring size " + std::to_string(ringSize));
+        }
+
+        input.signatures = signatures;
+    }
+
+    return inputs;
+}
+
+/* Cross checks the interleaved ring signature kernel against the reference
+   implementation, on both valid and tampered rings */
+void testRingSignatureInterleaved()
+{
+    for (size_t ringSize = 1; ringSize <= 16; ringSize++)
+    {
+        auto input = generateRingSignatureInputs(1, ringSize)[0];
+
+        /* Fails the test if the kernels disagree, or don't give the expected result */
+        const auto check = [&input, ringSize](const bool expected, const std::string &tampered)
+        {
+            const common::ArrayView<PublicKey> publicKeys(input.publicKeys.data(), input.publicKeys.size());
+            const common::ArrayView<Signature> signatures(input.signatures.data(), input.signatures.size());
+
+            const bool reference = crypto_ops::checkRingSignature(input.prefixHash, input.keyImage, publicKeys, signatures);
+            const bool interleaved = crypto_ops::checkRingSignatureInterleaved(input.prefixHash, input.keyImage, publicKeys, signatures);
+
+            if (reference != expected || interleaved != expected)
+            {
+                failCheck("Ring size " + std::to_string(ringSize) + ", tampered with " + tampered
+                          + ": expected " + (expected ? "valid" : "invalid")
+                          + ", checkRingSignature: " + (reference ? "valid" : "invalid")
+                          + ", checkRingSignatureInterleaved: " + (interleaved ? "valid" : "invalid"));
+            }
+        };
+
+        check(true, "nothing");
+
+        /* Tamper with each part of the signature in turn, restoring it afterwards */
+        input.prefixHash.data[0] ^= 1;
+        check(false, "the prefix hash");
+        input.prefixHash.data[0] ^= 1;
+
+        input.signatures[ringSize - 1].data[5] ^= 1;
+        check(false, "the last signature's c");
+        input.signatures[ringSize - 1].data[5] ^= 1;
+
+        input.signatures[0].data[37] ^= 1;
+        check(false, "the first signature's r");
+        input.signatures[0].data[37] ^= 1;
+
+        if (ringSize > 1)
+        {
+            std::swap(input.publicKeys.front(), input.publicKeys.back());
+            check(false, "the public key order");
+            std::swap(input.publicKeys.front(), input.publicKeys.back());
+        }
+
+        input.keyImage.data[3] ^= 1;
+        check(false, "the key image");
+        input.keyImage.data[3] ^= 1;
+
+        check(true, "nothing, after restoring it");
+    }
+
+    std::cout << "checkRingSignatureInterleaved: matches checkRingSignature" << std::endl;
+}
+
+/* Compares verifying ring signatures through freshly copied vectors, as the
+   by-value API used to force on every call, with verifying them in place */
+void benchmarkRingSignatureCopies()
+{
+    const uint64_t loopIterations = 200;
+
+    for (size_t ringSize = 3; ringSize <= 16; ringSize++)
+    {
+        const auto inputs = generateRingSignatureInputs(1, ringSize);
+        const auto &input = inputs[0];
+
+        auto startTimer = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t i = 0; i < loopIterations; i++)
+        {
+            const std::vector<PublicKey> publicKeys = input.publicKeys;
+            const std::vector<Signature> signatures = input.signatures;
+
+            if (!crypto_ops::checkRingSignature(input.prefixHash, input.keyImage, publicKeys, signatures))
+            {
+                failCheck("checkRingSignature rejected a valid signature (copying, ring size " + std::to_string(ringSize) + ")");
+            }
+        }
+
+        const auto copyingTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - startTimer).count();
+
+        startTimer = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t i = 0; i < loopIterations; i++)
+        {
+            const bool valid = crypto_ops::checkRingSignature(
+                input.prefixHash,
+                input.keyImage,
+                {input.publicKeys.data(), input.publicKeys.size()},
+                {input.signatures.data(), input.signatures.size()});
+
+            if (!valid)
+            {
+                failCheck("checkRingSignature rejected a valid signature (in place, ring size " + std::to_string(ringSize) + ")");
+            }
+        }
+
+        const auto inPlaceTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - startTimer).count();
+
+        std::cout << "checkRingSignature (ring size " << ringSize << "): "
+                  << "copying: " << copyingTime / static_cast<double>(loopIterations) << " us, "
+                  << "in place: " << inPlaceTime / static_cast<double>(loopIterations) << " us, "
+                  << "saved 2 allocations / " << ringSize * (sizeof(PublicKey) + sizeof(Signature))
+                  << " bytes copied per check" << std::endl;
+    }
+}
+
+/* Compares the reference ring signature verification with the interleaved kernel */
+void benchmarkRingSignatureInterleaved()
+{
+    const uint64_t loopIterations = 200;
+
+    for (size_t ringSize : {4, 8, 16})
+    {
+        const auto input = generateRingSignatureInputs(1, ringSize)[0];
+
+        const common::ArrayView<PublicKey> publicKeys(input.publicKeys.data(), input.publicKeys.size());
+        const common::ArrayView<Signature> signatures(input.signatures.data(), input.signatures.size());
+
+        auto startTimer = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t i = 0; i < loopIterations; i++)
+        {
+            if (!crypto_ops::checkRingSignature(input.prefixHash, input.keyImage, publicKeys, signatures))
+            {
+                failCheck("checkRingSignature rejected a valid signature (ring size " + std::to_string(ringSize) + ")");
+            }
+        }
+
+        const auto referenceTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - startTimer).count();
+
+        startTimer = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t i = 0; i < loopIterations; i++)
+        {
+            if (!crypto_ops::checkRingSignatureInterleaved(input.prefixHash, input.keyImage, publicKeys, signatures))
+            {
+                failCheck("checkRingSignatureInterleaved rejected a valid signature (ring size " + std::to_string(ringSize) + ")");
+            }
+        }
+
+        const auto interleavedTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - startTimer).count();
+
+        std::cout << "Ring signature verification (ring size " << ringSize << "): "
+                  << "reference: " << referenceTime / static_cast<double>(loopIterations) << " us, "
+                  << "interleaved: " << interleavedTime / static_cast<double>(loopIterations) << " us" << std::endl;
+    }
+}
+
+/* Verifies synthetic blocks the same way Core does, splitting the inputs of a
+   block into one contiguous chunk per worker, for increasing thread counts */
+void benchmarkParallelRingSignatureVerification()
+{
+    const size_t inputsPerBlock = 64;
+    const size_t ringSize = 4;
+    const size_t blockCount = 20;
+
+    const auto inputs = generateRingSignatureInputs(inputsPerBlock, ringSize);
+
+    const size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        const size_t chunkSize = (inputs.size() + threads - 1) / threads;
+
+        /* Declared before the pool, so it outlives any job still queued when
+           the pool is destroyed */
+        const auto checkRange = [&inputs](size_t start, size_t end)
+        {
+            for (size_t i = start; i < end; i++)
+            {
+                const auto &input = inputs[i];
+
+                if (!crypto_ops::checkRingSignature(input.prefixHash, input.keyImage, input.publicKeys, input.signatures))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        };
+
+        common::ThreadPool pool(threads);
+
+        auto startTimer = std::chrono::high_resolution_clock::now();
+
+        for (size_t block = 0; block < blockCount; block++)
+        {
+            std::vector<std::future<bool>> results;
+
+            for (size_t start = 0; start < inputs.size(); start += chunkSize)
+            {
+                const size_t end = std::min(start + chunkSize, inputs.size());
+
+                results.push_back(pool.addJob([&checkRange, start, end]
+                                              { return checkRange(start, end); }));
+            }
+
+            /* Waits for the block to be verified */
+            for (auto &result : results)
+            {
+                if (!result.get())
+                {
+                    failCheck("Parallel ring signature verification rejected a valid signature");
+                }
+            }
+        }
+
+        auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+        const auto elapsedMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count();
+
+        std::cout << "Ring signature verification (" << threads << " thread(s), " << inputsPerBlock
+                  << " inputs/block, ring size " << ringSize << "): "
+                  << (blockCount * 1000.0 / std::max<int64_t>(elapsedMilliseconds, 1)) << " blocks/s" << std::endl;
+    }
+}
+
 int main(int argc, char **argv)
 {
     bool o_help, o_version, o_benchmark;
@@ -365,12 +644,19 @@ int main(int argc, char **argv)
             TEST_HASH_FUNCTION_WITH_HEIGHT(cn_soft_shell_slow_hash_v2, CN_SOFT_SHELL_V2[height / 512], height);
         }
 
+        std::cout << std::endl;
+
+        testRingSignatureInterleaved();
+
         if (o_benchmark)
         {
             std::cout << "\nPerformance Tests: Please wait, this may take a while depending on your system...\n\n";
 
             benchmarkUnderivePublicKey();
             benchmarkGenerateKeyDerivation();
+            benchmarkRingSignatureCopies();
+            benchmarkRingSignatureInterleaved();
+            benchmarkParallelRingSignatureVerification();
 
             BENCHMARK(cn_slow_hash_v0, o_iterations);
             BENCHMARK(cn_slow_hash_v1, o_iterations);
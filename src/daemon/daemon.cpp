@@ -286,6 +286,9 @@ int main(int argc, char *argv[])
 
         DataBaseConfig dbConfig;
         dbConfig.init(config.dataDirectory, config.dbThreads, config.dbMaxOpenFiles, config.dbWriteBufferSizeMB, config.dbReadCacheSizeMB);
+        dbConfig.setCompression(config.dbCompression, config.dbBottommostCompression);
+        dbConfig.setBlockCache(config.dbCacheType, config.dbCacheIndexFilters, config.dbCacheHighPriorityPercent, config.dbPinL0Filters);
+        dbConfig.setStatistics(config.dbStatistics);
 
         if (dbConfig.isConfigFolderDefaulted())
         {
@@ -45,7 +45,7 @@ namespace DaemonConfig
 
         options.add_options("Peer")("add-exclusive-node", "Manually add a peer to the local peer list ONLY attempt connections to it. [ip:port]", cxxopts::value<std::vector<std::string>>(), "<ip:port>")("add-peer", "Manually add a peer to the local peer list", cxxopts::value<std::vector<std::string>>(), "<ip:port>")("add-priority-node", "Manually add a peer to the local peer list and attempt to maintain a connection to it [ip:port]", cxxopts::value<std::vector<std::string>>(), "<ip:port>")("seed-node", "Connect to a node to retrieve the peer list and then disconnect", cxxopts::value<std::vector<std::string>>(), "<ip:port>");
 
-        options.add_options("Database")("db-max-open-files", "Number of files that can be used by the database at one time", cxxopts::value<int>()->default_value(std::to_string(config.dbMaxOpenFiles)), "#")("db-read-buffer-size", "Size of the database read cache in megabytes (MB)", cxxopts::value<int>()->default_value(std::to_string(config.dbReadCacheSizeMB)), "#")("db-threads", "Number of background threads used for compaction and flush operations", cxxopts::value<int>()->default_value(std::to_string(config.dbThreads)), "#")("db-write-buffer-size", "Size of the database write buffer in megabytes (MB)", cxxopts::value<int>()->default_value(std::to_string(config.dbWriteBufferSizeMB)), "#");
+        options.add_options("Database")("db-max-open-files", "Number of files that can be used by the database at one time", cxxopts::value<int>()->default_value(std::to_string(config.dbMaxOpenFiles)), "#")("db-read-buffer-size", "Size of the database read cache in megabytes (MB)", cxxopts::value<int>()->default_value(std::to_string(config.dbReadCacheSizeMB)), "#")("db-threads", "Number of background threads used for compaction and flush operations", cxxopts::value<int>()->default_value(std::to_string(config.dbThreads)), "#")("db-write-buffer-size", "Size of the database write buffer in megabytes (MB)", cxxopts::value<int>()->default_value(std::to_string(config.dbWriteBufferSizeMB)), "#")("db-compression", "Compression used for the upper levels of the database: auto, none, snappy, lz4 or zstd. auto picks lz4 if this build supports it", cxxopts::value<std::string>()->default_value(config.dbCompression), "<type>")("db-bottommost-compression", "Compression used for the bottommost level of the database, which holds most of the data: auto, none, snappy, lz4 or zstd. auto picks zstd if this build supports it", cxxopts::value<std::string>()->default_value(config.dbBottommostCompression), "<type>")("db-cache-type", "Type of the database read cache: lru or clock", cxxopts::value<std::string>()->default_value(config.dbCacheType), "<type>")("db-cache-index-filters", "Keep database index and filter blocks in the read cache, rather than always in memory. Only worth it with a read cache of several hundred MB", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))("db-cache-high-priority", "Percentage of the database read cache reserved for index and filter blocks, with --db-cache-index-filters", cxxopts::value<int>()->default_value(std::to_string(config.dbCacheHighPriorityPercent)), "#")("db-pin-l0-filters", "Keep the index and filter blocks of the newest database files in the read cache, with --db-cache-index-filters", cxxopts::value<bool>()->default_value("true")->implicit_value("true"))("db-statistics", "Collect database statistics, and log the on disk size and read amplification on shutdown", cxxopts::value<bool>()->default_value("false")->implicit_value("true"));
 
         try
         {
@@ -141,6 +141,41 @@ namespace DaemonConfig
                 config.dbWriteBufferSizeMB = cli["db-write-buffer-size"].as<int>();
             }
 
+            if (cli.count("db-compression") > 0)
+            {
+                config.dbCompression = cli["db-compression"].as<std::string>();
+            }
+
+            if (cli.count("db-bottommost-compression") > 0)
+            {
+                config.dbBottommostCompression = cli["db-bottommost-compression"].as<std::string>();
+            }
+
+            if (cli.count("db-cache-type") > 0)
+            {
+                config.dbCacheType = cli["db-cache-type"].as<std::string>();
+            }
+
+            if (cli.count("db-cache-index-filters") > 0)
+            {
+                config.dbCacheIndexFilters = cli["db-cache-index-filters"].as<bool>();
+            }
+
+            if (cli.count("db-cache-high-priority") > 0)
+            {
+                config.dbCacheHighPriorityPercent = cli["db-cache-high-priority"].as<int>();
+            }
+
+            if (cli.count("db-pin-l0-filters") > 0)
+            {
+                config.dbPinL0Filters = cli["db-pin-l0-filters"].as<bool>();
+            }
+
+            if (cli.count("db-statistics") > 0)
+            {
+                config.dbStatistics = cli["db-statistics"].as<bool>();
+            }
+
             if (cli.count("local-ip") > 0)
             {
                 config.localIp = cli["local-ip"].as<bool>();
@@ -359,6 +394,48 @@ namespace DaemonConfig
                         throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey);
                     }
                 }
+                else if (cfgKey.compare("db-compression") == 0)
+                {
+                    config.dbCompression = cfgValue;
+                    updated = true;
+                }
+                else if (cfgKey.compare("db-bottommost-compression") == 0)
+                {
+                    config.dbBottommostCompression = cfgValue;
+                    updated = true;
+                }
+                else if (cfgKey.compare("db-cache-type") == 0)
+                {
+                    config.dbCacheType = cfgValue;
+                    updated = true;
+                }
+                else if (cfgKey.compare("db-cache-index-filters") == 0)
+                {
+                    config.dbCacheIndexFilters = cfgValue.at(0) == '1' ? true : false;
+                    updated = true;
+                }
+                else if (cfgKey.compare("db-cache-high-priority") == 0)
+                {
+                    try
+                    {
+                        config.dbCacheHighPriorityPercent = std::stoi(cfgValue);
+                        updated = true;
+                    }
+                    catch (std::exception &e)
+                    {
+                        throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey);
+                    }
+                }
+                else if (cfgKey.compare("db-pin-l0-filters") == 0)
+                {
+                    config.dbPinL0Filters = cfgValue.at(0) == '1' ? true : false;
+                    updated = true;
+                }
+                else if (cfgKey.compare("db-statistics") == 0)
+                {
+                    config.dbStatistics = cfgValue.at(0) == '1' ? true : false;
+                    updated = true;
+                }
                 else if (cfgKey.compare("allow-local-ip") == 0)
                 {
                     config.localIp = cfgValue.at(0) == '1' ? true : false;
@@ -557,6 +634,41 @@ namespace DaemonConfig
             config.dbWriteBufferSizeMB = j["db-write-buffer-size"].get<int>();
         }
 
+        if (j.find("db-compression") != j.end())
+        {
+            config.dbCompression = j["db-compression"].get<std::string>();
+        }
+
+        if (j.find("db-bottommost-compression") != j.end())
+        {
+            config.dbBottommostCompression = j["db-bottommost-compression"].get<std::string>();
+        }
+
+        if (j.find("db-cache-type") != j.end())
+        {
+            config.dbCacheType = j["db-cache-type"].get<std::string>();
+        }
+
+        if (j.find("db-cache-index-filters") != j.end())
+        {
+            config.dbCacheIndexFilters = j["db-cache-index-filters"].get<bool>();
+        }
+
+        if (j.find("db-cache-high-priority") != j.end())
+        {
+            config.dbCacheHighPriorityPercent = j["db-cache-high-priority"].get<int>();
+        }
+
+        if (j.find("db-pin-l0-filters") != j.end())
+        {
+            config.dbPinL0Filters = j["db-pin-l0-filters"].get<bool>();
+        }
+
+        if (j.find("db-statistics") != j.end())
+        {
+            config.dbStatistics = j["db-statistics"].get<bool>();
+        }
+
         if (j.find("allow-local-ip") != j.end())
         {
             config.localIp = j["allow-local-ip"].get<bool>();
@@ -645,6 +757,13 @@ namespace DaemonConfig
             {"db-read-buffer-size", (config.dbReadCacheSizeMB)},
             {"db-threads", config.dbThreads},
             {"db-write-buffer-size", (config.dbWriteBufferSizeMB)},
+            {"db-compression", config.dbCompression},
+            {"db-bottommost-compression", config.dbBottommostCompression},
+            {"db-cache-type", config.dbCacheType},
+            {"db-cache-index-filters", config.dbCacheIndexFilters},
+            {"db-cache-high-priority", config.dbCacheHighPriorityPercent},
+            {"db-pin-l0-filters", config.dbPinL0Filters},
+            {"db-statistics", config.dbStatistics},
             {"allow-local-ip", config.localIp},
             {"hide-my-port", config.hideMyPort},
             {"p2p-bind-ip", config.p2pInterface},
@@ -30,6 +30,13 @@ namespace DaemonConfig
             dbReadCacheSizeMB = mevacoin::DATABASE_READ_BUFFER_MB_DEFAULT_SIZE;
             dbThreads = mevacoin::DATABASE_DEFAULT_BACKGROUND_THREADS_COUNT;
             dbWriteBufferSizeMB = mevacoin::DATABASE_WRITE_BUFFER_MB_DEFAULT_SIZE;
+            dbCompression = mevacoin::DATABASE_DEFAULT_COMPRESSION;
+            dbBottommostCompression = mevacoin::DATABASE_DEFAULT_BOTTOMMOST_COMPRESSION;
+            dbCacheType = mevacoin::DATABASE_DEFAULT_BLOCK_CACHE_TYPE;
+            dbCacheHighPriorityPercent = mevacoin::DATABASE_DEFAULT_HIGH_PRIORITY_POOL_PERCENT;
+            dbCacheIndexFilters = false;
+            dbPinL0Filters = true;
+            dbStatistics = false;
             rewindToHeight = 0;
             p2pInterface = "0.0.0.0";
             p2pPort = mevacoin::P2P_DEFAULT_PORT;
@@ -53,6 +60,9 @@ namespace DaemonConfig
         std::string rpcInterface;
         std::string p2pInterface;
         std::string checkPoints;
+        std::string dbCompression;
+        std::string dbBottommostCompression;
+        std::string dbCacheType;
 
         std::vector<std::string> peers;
         std::vector<std::string> priorityNodes;
@@ -69,8 +79,12 @@ namespace DaemonConfig
         int dbMaxOpenFiles;
         int dbWriteBufferSizeMB;
         int dbReadCacheSizeMB;
+        int dbCacheHighPriorityPercent;
         uint32_t rewindToHeight;
         bool noConsole;
+        bool dbCacheIndexFilters;
+        bool dbPinL0Filters;
+        bool dbStatistics;
         bool enableBlockExplorer;
         bool localIp;
         bool hideMyPort;
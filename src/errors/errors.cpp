@@ -264,6 +264,11 @@ std::string Error::getErrorMessage() const
     case HASH_INVALID:
     {
         return "The hash given is not a hex string (A-Za-z0-9)";
+    }
+    case TRANSACTION_CURSOR_NOT_FOUND:
+    {
+        return "The transaction to continue from was not found. It may have "
+               "been removed by a fork. Start again from the first page.";
     }
         /* No default case so the compiler warns us if we missed one */
     }
@@ -205,6 +205,10 @@ enum ErrorCode
        NOTE: Not used in WalletBackend, only here to maintain API compatibility
        with turtlecoin-wallet-backend-js */
     NON_INTEGER_GIVEN = 50,
+
+    /* The transaction given as a cursor to continue paging from is not in
+       the wallet, for example because a fork removed it */
+    TRANSACTION_CURSOR_NOT_FOUND = 51,
 };
 
 class Error
@@ -0,0 +1,78 @@
+// Copyright (c) 2019, The Kryptokrona Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "block_details_cache.h"
+
+namespace mevacoin
+{
+
+    BlockDetailsCache::BlockDetailsCache(size_t maxSize) : maxSize(maxSize), size(0)
+    {
+    }
+
+    bool BlockDetailsCache::get(const crypto::Hash &blockHash, BlockDetails &details)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        const auto it = index.find(blockHash);
+
+        if (it == index.end())
+        {
+            return false;
+        }
+
+        /* Move it to the front, so it's dropped last */
+        entries.splice(entries.begin(), entries, it->second);
+
+        details = *it->second;
+
+        return true;
+    }
+
+    void BlockDetailsCache::insert(const BlockDetails &details)
+    {
+        const size_t detailsSize = estimateSize(details);
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (detailsSize > maxSize || index.count(details.hash) != 0)
+        {
+            return;
+        }
+
+        entries.push_front(details);
+        index[details.hash] = entries.begin();
+        size += detailsSize;
+
+        while (size > maxSize)
+        {
+            size -= estimateSize(entries.back());
+            index.erase(entries.back().hash);
+            entries.pop_back();
+        }
+    }
+
+    void BlockDetailsCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        entries.clear();
+        index.clear();
+        size = 0;
+    }
+
+    size_t BlockDetailsCache::estimateSize(const BlockDetails &details)
+    {
+        size_t result = sizeof(BlockDetails);
+
+        /* The decoded transactions take up a bit more than their binary size */
+        for (const auto &transaction : details.transactions)
+        {
+            result += sizeof(TransactionDetails) + 2 * transaction.size;
+        }
+
+        return result;
+    }
+
+}
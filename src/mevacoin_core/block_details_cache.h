@@ -0,0 +1,50 @@
+// Copyright (c) 2019, The Kryptokrona Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "blockchain_explorer_data.h"
+
+namespace mevacoin
+{
+
+    /* Holds the details of recently looked up blocks, up to roughly the given
+       number of bytes, dropping the least recently used first. It's up to the
+       user to only add blocks whose details can't change, and to clear it if
+       they might have. */
+    class BlockDetailsCache
+    {
+    public:
+        explicit BlockDetailsCache(size_t maxSize);
+
+        BlockDetailsCache(const BlockDetailsCache &) = delete;
+        BlockDetailsCache &operator=(const BlockDetailsCache &) = delete;
+
+        bool get(const crypto::Hash &blockHash, BlockDetails &details);
+
+        void insert(const BlockDetails &details);
+
+        void clear();
+
+    private:
+        /* Roughly how much memory the details of a block take up */
+        static size_t estimateSize(const BlockDetails &details);
+
+        const size_t maxSize;
+
+        size_t size;
+
+        /* Most recently used first */
+        std::list<BlockDetails> entries;
+
+        std::unordered_map<crypto::Hash, std::list<BlockDetails>::iterator> index;
+
+        std::mutex mutex;
+    };
+
+}
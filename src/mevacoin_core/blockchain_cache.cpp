@@ -907,6 +907,11 @@ namespace mevacoin
         serialize(s);
     }
 
+    void BlockchainCache::setBulkSync(bool bulkSync)
+    {
+        // blocks are only kept in memory, there are no writes to batch
+    }
+
     bool BlockchainCache::isTransactionSpendTimeUnlocked(uint64_t unlockTime) const
     {
         return isTransactionSpendTimeUnlocked(unlockTime, getTopBlockIndex());
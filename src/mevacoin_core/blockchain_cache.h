@@ -165,6 +165,7 @@ namespace mevacoin
 
         virtual void save() override;
         virtual void load() override;
+        virtual void setBulkSync(bool bulkSync) override;
 
         virtual std::vector<BinaryArray> getRawTransactions(const std::vector<crypto::Hash> &transactions,
                                                             std::vector<crypto::Hash> &missedTransactions) const override;
@@ -113,6 +113,12 @@ BlockchainReadBatch &BlockchainReadBatch::requestKeyOutputAmountsCount()
     return *this;
 }
 
+BlockchainReadBatch &BlockchainReadBatch::requestKeyOutputAmount(uint32_t amountIndex)
+{
+    state.keyOutputAmounts.emplace(amountIndex, 0);
+    return *this;
+}
+
 BlockchainReadBatch &BlockchainReadBatch::requestTransactionCountByPaymentId(const crypto::Hash &paymentId)
 {
     state.transactionCountsByPaymentIds.emplace(paymentId, 0);
@@ -262,6 +268,11 @@ uint32_t BlockchainReadResult::getKeyOutputAmountsCount() const
     return state.keyOutputAmountsCount.first;
 }
 
+const std::unordered_map<uint32_t, IBlockchainCache::Amount> &BlockchainReadResult::getKeyOutputAmounts() const
+{
+    return state.keyOutputAmounts;
+}
+
 const std::unordered_map<crypto::Hash, uint32_t> &BlockchainReadResult::getTransactionCountByPaymentIds() const
 {
     return state.transactionCountsByPaymentIds;
@@ -99,6 +99,7 @@ namespace mevacoin
         const std::pair<uint32_t, bool> &getLastBlockIndex() const;
         const std::unordered_map<uint64_t, uint32_t> &getClosestTimestampBlockIndex() const;
         uint32_t getKeyOutputAmountsCount() const;
+        const std::unordered_map<uint32_t, IBlockchainCache::Amount> &getKeyOutputAmounts() const;
         const std::unordered_map<crypto::Hash, uint32_t> &getTransactionCountByPaymentIds() const;
         const std::unordered_map<std::pair<crypto::Hash, uint32_t>, crypto::Hash> &getTransactionHashesByPaymentIds() const;
         const std::unordered_map<uint64_t, std::vector<crypto::Hash>> &getBlockHashesByTimestamp() const;
@@ -129,6 +130,7 @@ namespace mevacoin
         BlockchainReadBatch &requestLastBlockIndex();
         BlockchainReadBatch &requestClosestTimestampBlockIndex(uint64_t timestamp);
         BlockchainReadBatch &requestKeyOutputAmountsCount();
+        BlockchainReadBatch &requestKeyOutputAmount(uint32_t amountIndex);
         BlockchainReadBatch &requestTransactionCountByPaymentId(const crypto::Hash &paymentId);
         BlockchainReadBatch &requestTransactionHashByPaymentId(const crypto::Hash &paymentId, uint32_t transactionIndexWithinPaymentId);
         BlockchainReadBatch &requestBlockHashesByTimestamp(uint64_t timestamp);
@@ -0,0 +1,216 @@
+// Copyright (c) 2019, The Kryptokrona Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "buffered_database.h"
+
+#include <vector>
+
+namespace mevacoin
+{
+
+    namespace
+    {
+
+        class RawWriteBatch : public IWriteBatch
+        {
+        public:
+            std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override
+            {
+                return std::move(rawDataToInsert);
+            }
+
+            std::vector<std::string> extractRawKeysToRemove() override
+            {
+                return std::move(rawKeysToRemove);
+            }
+
+            std::vector<std::pair<std::string, std::string>> rawDataToInsert;
+            std::vector<std::string> rawKeysToRemove;
+        };
+
+        class RawReadBatch : public IReadBatch
+        {
+        public:
+            std::vector<std::string> getRawKeys() const override
+            {
+                return rawKeys;
+            }
+
+            void submitRawResult(const std::vector<std::string> &values, const std::vector<bool> &resultStates) override
+            {
+                rawValues = values;
+                rawResultStates = resultStates;
+            }
+
+            std::vector<std::string> rawKeys;
+            std::vector<std::string> rawValues;
+            std::vector<bool> rawResultStates;
+        };
+
+    }
+
+    BufferedDatabase::BufferedDatabase(IDataBase &database, size_t maxBufferedWrites, size_t maxBufferedSize)
+        : database(database),
+          maxBufferedWrites(maxBufferedWrites),
+          maxBufferedSize(maxBufferedSize),
+          buffering(false),
+          bufferedWrites(0),
+          bufferedSize(0)
+    {
+    }
+
+    BufferedDatabase::~BufferedDatabase()
+    {
+        /* Nothing we can do about a failure here. Whatever is lost is still
+           in the main chain storage, and is imported again on the next start */
+        flush();
+    }
+
+    std::error_code BufferedDatabase::write(IWriteBatch &batch)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!buffering)
+        {
+            /* Only left over if committing it failed before */
+            const auto error = flushBuffer();
+
+            return error ? error : database.write(batch);
+        }
+
+        /* Same order the database applies them in, inserts then removals */
+        for (auto &keyValue : batch.extractRawDataToInsert())
+        {
+            bufferedSize += keyValue.first.size() + keyValue.second.size();
+            buffer[std::move(keyValue.first)] = std::move(keyValue.second);
+        }
+
+        for (auto &key : batch.extractRawKeysToRemove())
+        {
+            bufferedSize += key.size();
+            buffer[std::move(key)] = boost::none;
+        }
+
+        if (++bufferedWrites >= maxBufferedWrites || bufferedSize >= maxBufferedSize)
+        {
+            return flushBuffer();
+        }
+
+        return std::error_code();
+    }
+
+    std::error_code BufferedDatabase::read(IReadBatch &batch)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (buffer.empty())
+        {
+            return database.read(batch);
+        }
+
+        const std::vector<std::string> keys = batch.getRawKeys();
+
+        std::vector<std::string> values(keys.size());
+        std::vector<bool> resultStates(keys.size(), false);
+
+        /* Keys that haven't been written since we started buffering, and the
+           position of each in the batch */
+        RawReadBatch unbufferedBatch;
+        std::vector<size_t> unbufferedPositions;
+
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            const auto it = buffer.find(keys[i]);
+
+            if (it == buffer.end())
+            {
+                unbufferedBatch.rawKeys.push_back(keys[i]);
+                unbufferedPositions.push_back(i);
+            }
+            else if (it->second)
+            {
+                values[i] = *it->second;
+                resultStates[i] = true;
+            }
+        }
+
+        if (!unbufferedBatch.rawKeys.empty())
+        {
+            const auto error = database.read(unbufferedBatch);
+
+            if (error)
+            {
+                return error;
+            }
+
+            for (size_t i = 0; i < unbufferedPositions.size(); i++)
+            {
+                values[unbufferedPositions[i]] = std::move(unbufferedBatch.rawValues[i]);
+                resultStates[unbufferedPositions[i]] = unbufferedBatch.rawResultStates[i];
+            }
+        }
+
+        batch.submitRawResult(values, resultStates);
+
+        return std::error_code();
+    }
+
+    std::error_code BufferedDatabase::setBuffering(bool enable)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        buffering = enable;
+
+        return enable ? std::error_code() : flushBuffer();
+    }
+
+    bool BufferedDatabase::isBuffering() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        return buffering;
+    }
+
+    std::error_code BufferedDatabase::flush()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        return flushBuffer();
+    }
+
+    std::error_code BufferedDatabase::flushBuffer()
+    {
+        if (buffer.empty())
+        {
+            return std::error_code();
+        }
+
+        RawWriteBatch batch;
+
+        for (auto &keyValue : buffer)
+        {
+            if (keyValue.second)
+            {
+                batch.rawDataToInsert.emplace_back(keyValue.first, *keyValue.second);
+            }
+            else
+            {
+                batch.rawKeysToRemove.push_back(keyValue.first);
+            }
+        }
+
+        const auto error = database.write(batch);
+
+        /* Keep the buffer on failure, so reads stay consistent with what was written */
+        if (!error)
+        {
+            buffer.clear();
+            bufferedWrites = 0;
+            bufferedSize = 0;
+        }
+
+        return error;
+    }
+
+}
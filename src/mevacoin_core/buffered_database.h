@@ -0,0 +1,64 @@
+// Copyright (c) 2019, The Kryptokrona Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+#include "idatabase.h"
+
+namespace mevacoin
+{
+
+    /* Passes reads and writes through to another database. While buffering,
+       writes are kept in memory and committed to the database together, in
+       one batch, once enough of them have built up. Reads see the buffered
+       writes, so to users of this class the database looks up to date. */
+    class BufferedDatabase : public IDataBase
+    {
+    public:
+        BufferedDatabase(IDataBase &database, size_t maxBufferedWrites, size_t maxBufferedSize);
+
+        /* Commits anything still buffered */
+        virtual ~BufferedDatabase();
+
+        BufferedDatabase(const BufferedDatabase &) = delete;
+        BufferedDatabase &operator=(const BufferedDatabase &) = delete;
+
+        std::error_code write(IWriteBatch &batch) override;
+        std::error_code read(IReadBatch &batch) override;
+
+        /* Turning buffering off commits anything buffered */
+        std::error_code setBuffering(bool buffering);
+        bool isBuffering() const;
+
+        std::error_code flush();
+
+    private:
+        std::error_code flushBuffer();
+
+        IDataBase &database;
+
+        const size_t maxBufferedWrites;
+
+        /* Bytes of keys and values */
+        const size_t maxBufferedSize;
+
+        bool buffering;
+
+        /* Keys that were removed map to no value */
+        std::unordered_map<std::string, boost::optional<std::string>> buffer;
+
+        size_t bufferedWrites;
+
+        size_t bufferedSize;
+
+        mutable std::mutex mutex;
+    };
+
+}
@@ -6,6 +6,7 @@
 // Please see the included LICENSE file for more information.
 
 #include <algorithm>
+#include <deque>
 
 #include <numeric>
 #include <iostream>
@@ -13,6 +14,7 @@
 #include <common/shuffle_generator.h>
 #include <common/math.h>
 #include <common/memory_input_stream.h>
+#include <common/scope_exit.h>
 #include <iterator>
 
 #include <mevacoin_core/blockchain_cache.h>
@@ -225,13 +227,42 @@ namespace mevacoin
 
         const std::chrono::seconds OUTDATED_TRANSACTION_POLLING_INTERVAL = std::chrono::seconds(60);
 
+        /* How many blocks each worker prepares ahead of the block being imported */
+        const size_t IMPORT_BLOCKS_AHEAD_PER_THREAD = 100;
+
+        const uint32_t IMPORT_PROGRESS_INTERVAL = 1000;
+
+        /* A block read from the main chain storage, deserialized and hashed,
+           ready to be pushed to the root segment */
+        struct PreparedBlock
+        {
+            RawBlock rawBlock;
+
+            BlockTemplate blockTemplate;
+
+            /* Refers to blockTemplate, so a prepared block is never moved */
+            std::unique_ptr<CachedBlock> cachedBlock;
+
+            std::vector<CachedTransaction> transactions;
+
+            TransactionValidatorState spentOutputs;
+
+            bool transactionsValid = false;
+
+            uint64_t cumulativeSize = 0;
+
+            uint64_t cumulativeFee = 0;
+        };
+
     }
 
     Core::Core(const Currency &currency, std::shared_ptr<logging::ILogger> logger, Checkpoints &&checkpoints, syst::Dispatcher &dispatcher,
                std::unique_ptr<IBlockchainCacheFactory> &&blockchainCacheFactory, std::unique_ptr<IMainChainStorage> &&mainchainStorage)
         : currency(currency), dispatcher(dispatcher), contextGroup(dispatcher), logger(logger, "Core"), checkpoints(std::move(checkpoints)),
           upgradeManager(new UpgradeManager()), blockchainCacheFactory(std::move(blockchainCacheFactory)),
-          mainChainStorage(std::move(mainchainStorage)), initialized(false)
+          mainChainStorage(std::move(mainchainStorage)), initialized(false),
+          workerPool(new common::ThreadPool(std::thread::hardware_concurrency())),
+          blockDetailsCache(BLOCK_DETAILS_CACHE_MAX_SIZE)
     {
 
         upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_2, currency.upgradeHeight(BLOCK_MAJOR_VERSION_2));
@@ -1062,12 +1093,7 @@ namespace mevacoin
 
         uint8_t nextBlockMajorVersion = getBlockMajorVersionForHeight(topBlockIndex);
 
-        size_t blocksCount = std::min(static_cast<size_t>(topBlockIndex), currency.difficultyBlocksCountByBlockVersion(nextBlockMajorVersion, topBlockIndex));
-
-        auto timestamps = mainChain->getLastTimestamps(blocksCount);
-        auto difficulties = mainChain->getLastCumulativeDifficulties(blocksCount);
-
-        return currency.getNextDifficulty(nextBlockMajorVersion, topBlockIndex, timestamps, difficulties);
+        return getNextBlockDifficulty(mainChain, topBlockIndex, nextBlockMajorVersion);
     }
 
     std::vector<crypto::Hash> Core::findBlockchainSupplement(const std::vector<crypto::Hash> &remoteBlockIds,
@@ -1143,7 +1169,7 @@ namespace mevacoin
             return blockValidationResult;
         }
 
-        auto currentDifficulty = cache->getDifficultyForNextBlock(previousBlockIndex);
+        auto currentDifficulty = getNextBlockDifficulty(cache, previousBlockIndex, getBlockMajorVersionForHeight(previousBlockIndex + 1));
         if (currentDifficulty == 0)
         {
             logger(logging::DEBUGGING) << "Block " << blockStr << " has difficulty overhead";
@@ -1220,10 +1246,14 @@ namespace mevacoin
 
         uint64_t cumulativeFee = 0;
 
+        /* Key image and output bookkeeping is done in order, the ring signatures
+           themselves are independent and are checked afterwards in parallel */
+        std::vector<RingSignatureCheck> signatureChecks;
+
         for (const auto &transaction : transactions)
         {
             uint64_t fee = 0;
-            auto transactionValidationResult = validateTransaction(transaction, validatorState, cache, fee, previousBlockIndex);
+            auto transactionValidationResult = validateTransaction(transaction, validatorState, cache, fee, previousBlockIndex, &signatureChecks);
             if (transactionValidationResult)
             {
                 logger(logging::DEBUGGING) << "Failed to validate transaction " << transaction.getTransactionHash() << ": " << transactionValidationResult.message();
@@ -1233,11 +1263,16 @@ namespace mevacoin
             cumulativeFee += fee;
         }
 
+        if (!checkRingSignatures(signatureChecks))
+        {
+            logger(logging::DEBUGGING) << "Failed to validate ring signatures of block " << blockStr;
+            return error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
+        }
+
         uint64_t reward = 0;
         int64_t emissionChange = 0;
         auto alreadyGeneratedCoins = cache->getAlreadyGeneratedCoins(previousBlockIndex);
-        auto lastBlocksSizes = cache->getLastBlocksSizes(currency.rewardBlocksWindow(), previousBlockIndex, addGenesisBlock);
-        auto blocksSizeMedian = common::medianValue(lastBlocksSizes);
+        auto blocksSizeMedian = getNextBlockSizeMedian(cache, previousBlockIndex);
 
         if (!currency.getBlockReward(cachedBlock.getBlock().majorVersion, blocksSizeMedian,
                                      cumulativeBlockSize, alreadyGeneratedCoins, cumulativeFee, reward, emissionChange))
@@ -1279,10 +1314,16 @@ namespace mevacoin
                 // TODO: exception safety
                 if (cache == chainsLeaves[0])
                 {
+                    /* Blocks up to the last checkpoint can't be reorganised away,
+                       so they don't need committing one at a time */
+                    cache->setBulkSync(checkpoints.isInCheckpointZone(cachedBlock.getBlockIndex() + 1));
+
                     mainChainStorage->pushBlock(rawBlock);
 
                     cache->pushBlock(cachedBlock, transactions, validatorState, cumulativeBlockSize, emissionChange, currentDifficulty, std::move(rawBlock));
 
+                    advanceNextBlockState(cachedBlock, cumulativeBlockSize, currentDifficulty);
+
                     updateBlockMedianSize();
 
                     // we've used these transactions, remove them from the pool if they are there
@@ -1901,21 +1942,11 @@ namespace mevacoin
 
         /* Skip the first N blocks, we don't have enough blocks to calculate a
            proper median yet */
-        if (height >= blockchain_timestamp_check_window)
+        if (const auto medianTimestamp = getNextBlockTimestampMedian(chainsLeaves[0], height - 1, blockchain_timestamp_check_window))
         {
-            std::vector<uint64_t> timestamps;
-
-            /* For the last N blocks, get their timestamps */
-            for (size_t offset = height - blockchain_timestamp_check_window; offset < height; offset++)
+            if (b.timestamp < *medianTimestamp)
             {
-                timestamps.push_back(getBlockTimestampByIndex(offset));
-            }
-
-            uint64_t medianTimestamp = common::medianValue(timestamps);
-
-            if (b.timestamp < medianTimestamp)
-            {
-                b.timestamp = medianTimestamp;
+                b.timestamp = *medianTimestamp;
             }
         }
 
@@ -2081,7 +2112,8 @@ namespace mevacoin
     }
 
     std::error_code Core::validateTransaction(const CachedTransaction &cachedTransaction, TransactionValidatorState &state,
-                                              IBlockchainCache *cache, uint64_t &fee, uint32_t blockIndex)
+                                              IBlockchainCache *cache, uint64_t &fee, uint32_t blockIndex,
+                                              std::vector<RingSignatureCheck> *deferredSignatureChecks)
     {
         // TransactionValidatorState currentState;
         const auto &transaction = cachedTransaction.getTransaction();
@@ -2135,7 +2167,15 @@ namespace mevacoin
                         return error::TransactionValidationError::INPUT_INVALID_SIGNATURES_COUNT;
                     }
 
-                    if (!crypto::crypto_ops::checkRingSignature(cachedTransaction.getTransactionPrefixHash(), in.keyImage, outputKeys, transaction.signatures[inputIndex]))
+                    if (deferredSignatureChecks != nullptr)
+                    {
+                        deferredSignatureChecks->push_back({&cachedTransaction, inputIndex, std::move(outputKeys)});
+                    }
+                    else if (!crypto::crypto_ops::checkRingSignature(
+                                 cachedTransaction.getTransactionPrefixHash(),
+                                 in.keyImage,
+                                 {outputKeys.data(), outputKeys.size()},
+                                 {transaction.signatures[inputIndex].data(), transaction.signatures[inputIndex].size()}))
                     {
                         return error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
                     }
@@ -2153,6 +2193,67 @@ namespace mevacoin
         return error::TransactionValidationError::VALIDATION_SUCCESS;
     }
 
+    bool Core::checkRingSignatures(const std::vector<RingSignatureCheck> &signatureChecks) const
+    {
+        const auto checkRange = [&signatureChecks](size_t start, size_t end)
+        {
+            for (size_t i = start; i < end; i++)
+            {
+                const auto &check = signatureChecks[i];
+                const auto &transaction = check.transaction->getTransaction();
+                const KeyInput &in = boost::get<KeyInput>(transaction.inputs[check.inputIndex]);
+                const auto &signatures = transaction.signatures[check.inputIndex];
+
+                if (!crypto::crypto_ops::checkRingSignature(
+                        check.transaction->getTransactionPrefixHash(),
+                        in.keyImage,
+                        {check.outputKeys.data(), check.outputKeys.size()},
+                        {signatures.data(), signatures.size()}))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        };
+
+        const size_t threadCount = workerPool->threadCount();
+
+        /* Not worth handing off to the pool */
+        if (threadCount <= 1 || signatureChecks.size() <= 1)
+        {
+            return checkRange(0, signatureChecks.size());
+        }
+
+        /* Split the checks into one contiguous chunk per worker */
+        const size_t chunkCount = std::min(threadCount, signatureChecks.size());
+        const size_t chunkSize = (signatureChecks.size() + chunkCount - 1) / chunkCount;
+
+        std::vector<std::future<bool>> results;
+        results.reserve(chunkCount);
+
+        for (size_t start = 0; start < signatureChecks.size(); start += chunkSize)
+        {
+            const size_t end = std::min(start + chunkSize, signatureChecks.size());
+
+            results.push_back(workerPool->addJob([&checkRange, start, end]
+                                                 { return checkRange(start, end); }));
+        }
+
+        /* Wait for every job, even after a failure, since they reference signatureChecks */
+        bool valid = true;
+
+        for (auto &result : results)
+        {
+            if (!result.get())
+            {
+                valid = false;
+            }
+        }
+
+        return valid;
+    }
+
     std::error_code Core::validateSemantic(const Transaction &transaction, uint64_t &fee, uint32_t blockIndex)
     {
         if (transaction.inputs.empty())
@@ -2326,14 +2427,10 @@ namespace mevacoin
             return error::BlockValidationError::TIMESTAMP_TOO_FAR_IN_FUTURE;
         }
 
-        auto timestamps = cache->getLastTimestamps(currency.timestampCheckWindow(previousBlockIndex + 1), previousBlockIndex, addGenesisBlock);
-        if (timestamps.size() >= currency.timestampCheckWindow(previousBlockIndex + 1))
+        const auto median_ts = getNextBlockTimestampMedian(cache, previousBlockIndex, currency.timestampCheckWindow(previousBlockIndex + 1));
+        if (median_ts && block.timestamp < *median_ts)
         {
-            auto median_ts = common::medianValue(timestamps);
-            if (block.timestamp < median_ts)
-            {
-                return error::BlockValidationError::TIMESTAMP_TOO_FAR_IN_PAST;
-            }
+            return error::BlockValidationError::TIMESTAMP_TOO_FAR_IN_PAST;
         }
 
         if (block.baseTransaction.inputs.size() != 1)
@@ -2476,17 +2573,79 @@ namespace mevacoin
 
         auto previousBlockHash = getBlockHash(mainChainStorage->getBlockByIndex(commonIndex));
         auto blockCount = mainChainStorage->getBlockCount();
+
+        /* Reading, deserializing and hashing a block doesn't depend on the blocks
+           before it, so it is done on the worker pool, ahead of the blocks being
+           pushed in order on this thread. Nothing writes to the main chain storage
+           while we import, so the workers can read from it. */
+        auto prepareBlock = [this](uint32_t blockIndex)
+        {
+            auto block = std::make_unique<PreparedBlock>();
+
+            block->rawBlock = mainChainStorage->getBlockByIndex(blockIndex);
+            block->blockTemplate = extractBlockTemplate(block->rawBlock);
+            block->cachedBlock = std::make_unique<CachedBlock>(block->blockTemplate);
+            block->cachedBlock->getBlockHash();
+
+            block->transactionsValid = extractTransactions(block->rawBlock.transactions, block->transactions, block->cumulativeSize);
+
+            if (block->transactionsValid)
+            {
+                for (const auto &transaction : block->transactions)
+                {
+                    transaction.getTransactionHash();
+                    block->cumulativeFee += transaction.getTransactionFee();
+                }
+
+                block->cumulativeSize += getObjectBinarySize(block->blockTemplate.baseTransaction);
+                block->spentOutputs = extractSpentOutputs(block->transactions);
+            }
+
+            return block;
+        };
+
+        const size_t blocksAhead = workerPool->threadCount() * IMPORT_BLOCKS_AHEAD_PER_THREAD;
+
+        std::deque<std::future<std::unique_ptr<PreparedBlock>>> preparedBlocks;
+
+        /* Don't leave the workers reading from the storage if we bail out */
+        tools::ScopeExit waitForWorkers([&preparedBlocks]()
+                                        {
+            for (auto &block : preparedBlocks)
+            {
+                block.wait();
+            } });
+
+        uint32_t nextBlockToPrepare = commonIndex + 1;
+
+        /* Everything we import is already in the main chain storage, and would
+           be imported again if we crash before it reaches the DB */
+        chainsLeaves[0]->setBulkSync(true);
+
+        const auto importStart = std::chrono::steady_clock::now();
+        auto progressStart = importStart;
+        uint32_t progressStartIndex = commonIndex + 1;
+
         for (uint32_t i = commonIndex + 1; i < blockCount; ++i)
         {
-            RawBlock rawBlock = mainChainStorage->getBlockByIndex(i);
-            auto blockTemplate = extractBlockTemplate(rawBlock);
-            CachedBlock cachedBlock(blockTemplate);
+            while (nextBlockToPrepare < blockCount && preparedBlocks.size() < blocksAhead)
+            {
+                const uint32_t blockIndex = nextBlockToPrepare++;
 
-            if (blockTemplate.previousBlockHash != previousBlockHash)
+                preparedBlocks.push_back(workerPool->addJob([&prepareBlock, blockIndex]
+                                                            { return prepareBlock(blockIndex); }));
+            }
+
+            std::unique_ptr<PreparedBlock> block = preparedBlocks.front().get();
+            preparedBlocks.pop_front();
+
+            const CachedBlock &cachedBlock = *block->cachedBlock;
+
+            if (block->blockTemplate.previousBlockHash != previousBlockHash)
             {
                 logger(logging::ERROR) << "Local blockchain corruption detected. " << std::endl
                                        << "Block with index " << i << " and hash " << cachedBlock.getBlockHash()
-                                       << " has previous block hash " << blockTemplate.previousBlockHash << ", but parent has hash " << previousBlockHash << "." << std::endl
+                                       << " has previous block hash " << block->blockTemplate.previousBlockHash << ", but parent has hash " << previousBlockHash << "." << std::endl
                                        << "Please try to repair this issue by starting the node with the option: --rewind " << i << std::endl
                                        << "If the above does not repair the issue, you can delete the DB folder and try to resync your node." << std::endl;
                 throw std::system_error(make_error_code(error::CoreErrorCode::CORRUPTED_BLOCKCHAIN));
@@ -2494,29 +2653,41 @@ namespace mevacoin
 
             previousBlockHash = cachedBlock.getBlockHash();
 
-            std::vector<CachedTransaction> transactions;
-            uint64_t cumulativeSize = 0;
-            if (!extractTransactions(rawBlock.transactions, transactions, cumulativeSize))
+            if (!block->transactionsValid)
             {
                 logger(logging::ERROR) << "Couldn't deserialize raw block transactions in block " << cachedBlock.getBlockHash();
                 throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
             }
 
-            cumulativeSize += getObjectBinarySize(blockTemplate.baseTransaction);
-            TransactionValidatorState spentOutputs = extractSpentOutputs(transactions);
             auto currentDifficulty = chainsLeaves[0]->getDifficultyForNextBlock(i - 1);
 
-            uint64_t cumulativeFee = std::accumulate(transactions.begin(), transactions.end(), UINT64_C(0), [](uint64_t fee, const CachedTransaction &transaction)
-                                                     { return fee + transaction.getTransactionFee(); });
+            int64_t emissionChange = getEmissionChange(currency, *chainsLeaves[0], i - 1, cachedBlock, block->cumulativeSize, block->cumulativeFee);
+            chainsLeaves[0]->pushBlock(cachedBlock, block->transactions, block->spentOutputs, block->cumulativeSize, emissionChange, currentDifficulty, std::move(block->rawBlock));
 
-            int64_t emissionChange = getEmissionChange(currency, *chainsLeaves[0], i - 1, cachedBlock, cumulativeSize, cumulativeFee);
-            chainsLeaves[0]->pushBlock(cachedBlock, transactions, spentOutputs, cumulativeSize, emissionChange, currentDifficulty, std::move(rawBlock));
-
-            if (i % 1000 == 0)
+            if (i % IMPORT_PROGRESS_INTERVAL == 0)
             {
-                logger(logging::INFO) << "Imported block with index " << i << " / " << (blockCount - 1);
+                const auto now = std::chrono::steady_clock::now();
+                const double seconds = std::chrono::duration<double>(now - progressStart).count();
+
+                logger(logging::INFO) << "Imported block with index " << i << " / " << (blockCount - 1)
+                                      << " (" << static_cast<uint64_t>((i + 1 - progressStartIndex) / std::max(seconds, 0.001)) << " blocks/s)";
+
+                progressStart = now;
+                progressStartIndex = i + 1;
             }
         }
+
+        chainsLeaves[0]->setBulkSync(false);
+
+        const uint32_t importedBlocks = blockCount - (commonIndex + 1);
+
+        if (importedBlocks != 0)
+        {
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - importStart).count();
+
+            logger(logging::INFO) << "Imported " << importedBlocks << " blocks in " << static_cast<uint64_t>(seconds) << " seconds ("
+                                  << static_cast<uint64_t>(importedBlocks / std::max(seconds, 0.001)) << " blocks/s)";
+        }
     }
 
     void Core::cutSegment(IBlockchainCache &segment, uint32_t startIndex)
@@ -2529,10 +2700,15 @@ namespace mevacoin
         logger(logging::INFO) << "Cutting root segment from index " << startIndex;
         auto childCache = segment.split(startIndex);
         segment.deleteChild(childCache.get());
+
+        blockDetailsCache.clear();
     }
 
     void Core::updateMainChainSet()
     {
+        /* The main chain changed, so the cached blocks may now be alternative */
+        blockDetailsCache.clear();
+
         mainChainSet.clear();
         IBlockchainCache *chainPtr = chainsLeaves[0];
         assert(chainPtr != nullptr);
@@ -2855,9 +3031,7 @@ namespace mevacoin
 
         assert(!chainsStorage.empty());
         assert(!chainsLeaves.empty());
-        // FIXME: skip gensis here?
-        auto sizes = chainsLeaves[0]->getLastBlocksSizes(currency.rewardBlocksWindow());
-        uint64_t median = common::medianValue(sizes);
+        uint64_t median = getTopBlockSizeMedian(chainsLeaves[0]);
         if (median <= nextBlockGrantedFullRewardZone)
         {
             median = nextBlockGrantedFullRewardZone;
@@ -3134,9 +3308,22 @@ namespace mevacoin
         }
 
         uint32_t blockIndex = segment->getBlockIndex(blockHash);
-        BlockTemplate blockTemplate = restoreBlockTemplate(segment, blockIndex);
+
+        const bool isAlternative = mainChainSet.count(segment) == 0;
+
+        /* Blocks this deep in the main chain can only change with a deep reorg,
+           which clears the cache */
+        const bool cacheable = !isAlternative && blockIndex + BLOCK_DETAILS_CACHE_MIN_DEPTH <= getTopBlockIndex();
 
         BlockDetails blockDetails;
+
+        if (cacheable && blockDetailsCache.get(blockHash, blockDetails))
+        {
+            return blockDetails;
+        }
+
+        BlockTemplate blockTemplate = restoreBlockTemplate(segment, blockIndex);
+
         blockDetails.majorVersion = blockTemplate.majorVersion;
         blockDetails.minorVersion = blockTemplate.minorVersion;
         blockDetails.timestamp = blockTemplate.timestamp;
@@ -3151,7 +3338,7 @@ namespace mevacoin
         }
 
         blockDetails.index = blockIndex;
-        blockDetails.isAlternative = mainChainSet.count(segment) == 0;
+        blockDetails.isAlternative = isAlternative;
 
         blockDetails.difficulty = getBlockDifficulty(blockIndex);
 
@@ -3170,8 +3357,8 @@ namespace mevacoin
         blockDetails.sizeMedian = 0;
         if (blockDetails.index > 0)
         {
-            auto lastBlocksSizes = segment->getLastBlocksSizes(currency.rewardBlocksWindow(), blockDetails.index - 1, addGenesisBlock);
-            blockDetails.sizeMedian = common::medianValue(lastBlocksSizes);
+            blockDetails.sizeMedian = getBlockSizeMedian(segment, blockDetails.index, blockHash, blockDetails.prevBlockHash,
+                                                         blockDetails.transactionsCumulativeSize);
             prevBlockGeneratedCoins = segment->getAlreadyGeneratedCoins(blockDetails.index - 1);
         }
 
@@ -3208,9 +3395,195 @@ namespace mevacoin
             blockDetails.totalFeeAmount += blockDetails.transactions.back().fee;
         }
 
+        if (cacheable)
+        {
+            blockDetailsCache.insert(blockDetails);
+        }
+
         return blockDetails;
     }
 
+    uint64_t Core::getBlockSizeMedian(IBlockchainCache *segment, uint32_t blockIndex, const crypto::Hash &blockHash,
+                                      const crypto::Hash &prevBlockHash, uint64_t blockSize) const
+    {
+        assert(blockIndex > 0);
+
+        std::lock_guard<std::mutex> lock(sizeMedianWindowMutex);
+
+        auto &window = sizeMedianWindow;
+
+        /* Not looking up the block after the last one, read the window in */
+        if (window.sizes.size() == 0 || window.lastBlockHash != prevBlockHash)
+        {
+            const auto sizes = segment->getLastBlocksSizes(currency.rewardBlocksWindow(), blockIndex - 1, addGenesisBlock);
+
+            window.sizes.assign(sizes.begin(), sizes.end());
+        }
+
+        const uint64_t median = window.sizes.median();
+
+        /* Move the window along to the next block */
+        window.sizes.push(blockSize, currency.rewardBlocksWindow());
+
+        window.lastBlockHash = blockHash;
+
+        return median;
+    }
+
+    Core::NextBlockState &Core::getNextBlockState(IBlockchainCache *segment, uint32_t previousBlockIndex) const
+    {
+        auto &state = nextBlockState;
+
+        const crypto::Hash lastBlockHash = segment->getBlockHash(previousBlockIndex);
+
+        if (state.lastBlockHash != lastBlockHash)
+        {
+            state = NextBlockState();
+            state.lastBlockHash = lastBlockHash;
+        }
+
+        /* Read in anything we don't have, including when a window gets bigger
+           at an upgrade height */
+        const size_t sizesCount = std::min<size_t>(currency.rewardBlocksWindow(), previousBlockIndex + 1);
+
+        if (state.sizes.size() != sizesCount)
+        {
+            const auto sizes = segment->getLastBlocksSizes(currency.rewardBlocksWindow(), previousBlockIndex, addGenesisBlock);
+            state.sizes.assign(sizes.begin(), sizes.end());
+        }
+
+        const size_t timestampsWindow = currency.timestampCheckWindow(previousBlockIndex + 1);
+
+        if (state.timestamps.size() != std::min<size_t>(timestampsWindow, previousBlockIndex + 1))
+        {
+            const auto timestamps = segment->getLastTimestamps(timestampsWindow, previousBlockIndex, addGenesisBlock);
+            state.timestamps.assign(timestamps.begin(), timestamps.end());
+        }
+
+        return state;
+    }
+
+    uint64_t Core::getNextBlockSizeMedian(IBlockchainCache *segment, uint32_t previousBlockIndex) const
+    {
+        std::lock_guard<std::mutex> lock(nextBlockStateMutex);
+
+        return getNextBlockState(segment, previousBlockIndex).sizes.median();
+    }
+
+    /* The median size of the last reward window of blocks on the segment,
+       which calculateCumulativeBlocksizeLimit() and updateBlockMedianSize()
+       use. This has always left it to the segment whether the genesis block
+       counts, unlike the window a new block is checked against, so it's read
+       in from the segment while the genesis block could still be in it. */
+    uint64_t Core::getTopBlockSizeMedian(IBlockchainCache *segment) const
+    {
+        const uint32_t topBlockIndex = segment->getTopBlockIndex();
+
+        if (topBlockIndex < currency.rewardBlocksWindow())
+        {
+            auto sizes = segment->getLastBlocksSizes(currency.rewardBlocksWindow());
+
+            return common::medianValue(sizes);
+        }
+
+        return getNextBlockSizeMedian(segment, topBlockIndex);
+    }
+
+    /* The median of the last windowSize timestamps, if there are that many blocks */
+    std::optional<uint64_t> Core::getNextBlockTimestampMedian(IBlockchainCache *segment, uint32_t previousBlockIndex, size_t windowSize) const
+    {
+        if (previousBlockIndex + 1 < windowSize)
+        {
+            return std::nullopt;
+        }
+
+        std::lock_guard<std::mutex> lock(nextBlockStateMutex);
+
+        const auto &state = getNextBlockState(segment, previousBlockIndex);
+
+        if (state.timestamps.size() == windowSize)
+        {
+            return state.timestamps.median();
+        }
+
+        /* Not the window we keep */
+        auto timestamps = segment->getLastTimestamps(windowSize, previousBlockIndex, addGenesisBlock);
+
+        return common::medianValue(timestamps);
+    }
+
+    uint64_t Core::getNextBlockDifficulty(IBlockchainCache *segment, uint32_t previousBlockIndex, uint8_t blockMajorVersion) const
+    {
+        std::lock_guard<std::mutex> lock(nextBlockStateMutex);
+
+        auto &state = getNextBlockState(segment, previousBlockIndex);
+
+        if (const auto it = state.nextDifficulty.find(blockMajorVersion); it != state.nextDifficulty.end())
+        {
+            return it->second;
+        }
+
+        const size_t count = currency.difficultyBlocksCountByBlockVersion(blockMajorVersion, previousBlockIndex);
+
+        /* The genesis block is left out */
+        const size_t available = std::min<size_t>(count, previousBlockIndex);
+
+        if (state.cumulativeDifficulties.size() < available)
+        {
+            const auto timestamps = segment->getLastTimestamps(count, previousBlockIndex, UseGenesis(false));
+            const auto difficulties = segment->getLastCumulativeDifficulties(count, previousBlockIndex, UseGenesis(false));
+
+            state.difficultyTimestamps.assign(timestamps.begin(), timestamps.end());
+            state.cumulativeDifficulties.assign(difficulties.begin(), difficulties.end());
+        }
+
+        state.difficultyWindowSize = std::max(state.difficultyWindowSize, count);
+
+        std::vector<uint64_t> timestamps(state.difficultyTimestamps.end() - available, state.difficultyTimestamps.end());
+        std::vector<uint64_t> difficulties(state.cumulativeDifficulties.end() - available, state.cumulativeDifficulties.end());
+
+        const uint64_t difficulty = currency.getNextDifficulty(blockMajorVersion, previousBlockIndex, std::move(timestamps), std::move(difficulties));
+
+        state.nextDifficulty[blockMajorVersion] = difficulty;
+
+        return difficulty;
+    }
+
+    /* Moves the windows along to the block just added to the top of the main chain */
+    void Core::advanceNextBlockState(const CachedBlock &block, uint64_t blockSize, uint64_t difficulty)
+    {
+        std::lock_guard<std::mutex> lock(nextBlockStateMutex);
+
+        auto &state = nextBlockState;
+
+        /* Will be read in from the chain if needed */
+        if (state.lastBlockHash != block.getBlock().previousBlockHash)
+        {
+            return;
+        }
+
+        const uint32_t blockIndex = block.getBlockIndex();
+        const uint64_t timestamp = block.getBlock().timestamp;
+
+        state.sizes.push(blockSize, currency.rewardBlocksWindow());
+        state.timestamps.push(timestamp, currency.timestampCheckWindow(blockIndex + 1));
+
+        if (!state.cumulativeDifficulties.empty())
+        {
+            state.difficultyTimestamps.push_back(timestamp);
+            state.cumulativeDifficulties.push_back(state.cumulativeDifficulties.back() + difficulty);
+
+            while (state.cumulativeDifficulties.size() > state.difficultyWindowSize)
+            {
+                state.difficultyTimestamps.pop_front();
+                state.cumulativeDifficulties.pop_front();
+            }
+        }
+
+        state.nextDifficulty.clear();
+        state.lastBlockHash = block.getBlockHash();
+    }
+
     TransactionDetails Core::getTransactionDetails(const crypto::Hash &transactionHash) const
     {
         throwIfNotInitialized();
@@ -3491,9 +3864,7 @@ namespace mevacoin
 
         size_t nextBlockGrantedFullRewardZone = currency.blockGrantedFullRewardZoneByBlockVersion(upgradeManager->getBlockMajorVersion(mainChain->getTopBlockIndex() + 1));
 
-        auto lastBlockSizes = mainChain->getLastBlocksSizes(currency.rewardBlocksWindow());
-
-        blockMedianSize = std::max(common::medianValue(lastBlockSizes), static_cast<uint64_t>(nextBlockGrantedFullRewardZone));
+        blockMedianSize = std::max(getTopBlockSizeMedian(mainChain), static_cast<uint64_t>(nextBlockGrantedFullRewardZone));
     }
 
     uint64_t Core::get_current_blockchain_height() const
@@ -6,8 +6,12 @@
 
 #pragma once
 #include <ctime>
+#include <deque>
+#include <mutex>
+#include <optional>
 #include <vector>
 #include <unordered_map>
+#include "block_details_cache.h"
 #include "blockchain_cache.h"
 #include "blockchain_messages.h"
 #include "cached_block.h"
@@ -26,6 +30,9 @@
 #include "message_queue.h"
 #include "transaction_validatior_state.h"
 
+#include <common/rolling_median.h>
+#include <common/thread_pool.h>
+
 #include <syst/context_group.h>
 
 #include <wallet_types.h>
@@ -33,6 +40,15 @@
 namespace mevacoin
 {
 
+    /* A ring signature check deferred until the rest of the block has been
+       validated, so the checks can be spread over the verification pool */
+    struct RingSignatureCheck
+    {
+        const CachedTransaction *transaction;
+        size_t inputIndex;
+        std::vector<crypto::PublicKey> outputKeys;
+    };
+
     class Core : public ICore, public ICoreInformation
     {
     public:
@@ -156,11 +172,62 @@ namespace mevacoin
 
         size_t blockMedianSize;
 
+        /* Long lived workers, used to verify the ring signatures of a block in
+           parallel, and to prepare blocks ahead of them being imported from storage */
+        std::unique_ptr<common::ThreadPool> workerPool;
+
+        /* Details of blocks deep enough in the main chain that they won't
+           change, for the block explorer RPC calls */
+        mutable BlockDetailsCache blockDetailsCache;
+
+        /* The sizes of the blocks the size median of the block after
+           lastBlockHash is taken from. Lets getBlockDetails() move the median
+           along when looking up consecutive blocks, instead of reading and
+           sorting the whole reward window for each. */
+        struct SizeMedianWindow
+        {
+            crypto::Hash lastBlockHash;
+            common::SlidingWindowMedian<uint64_t> sizes;
+        };
+
+        mutable SizeMedianWindow sizeMedianWindow;
+        mutable std::mutex sizeMedianWindowMutex;
+
+        /* The windows of block sizes, timestamps and cumulative difficulties the
+           block after lastBlockHash is checked against. They are moved along as
+           blocks are added to the top of the main chain, and only read in from
+           the chain again when asked about a different block, so validating a
+           block or making a template doesn't read and sort them every time. */
+        struct NextBlockState
+        {
+            crypto::Hash lastBlockHash;
+
+            /* The reward window, including the genesis block */
+            common::SlidingWindowMedian<uint64_t> sizes;
+
+            /* The timestamp check window, including the genesis block */
+            common::SlidingWindowMedian<uint64_t> timestamps;
+
+            /* The difficulty window, not including the genesis block. Empty
+               until the difficulty is first asked for. */
+            std::deque<uint64_t> difficultyTimestamps;
+            std::deque<uint64_t> cumulativeDifficulties;
+            size_t difficultyWindowSize = 0;
+
+            /* The difficulty of the next block, by block major version */
+            std::unordered_map<uint8_t, uint64_t> nextDifficulty;
+        };
+
+        mutable NextBlockState nextBlockState;
+        mutable std::mutex nextBlockStateMutex;
+
         void throwIfNotInitialized() const;
         bool extractTransactions(const std::vector<BinaryArray> &rawTransactions, std::vector<CachedTransaction> &transactions, uint64_t &cumulativeSize);
 
         std::error_code validateSemantic(const Transaction &transaction, uint64_t &fee, uint32_t blockIndex);
-        std::error_code validateTransaction(const CachedTransaction &transaction, TransactionValidatorState &state, IBlockchainCache *cache, uint64_t &fee, uint32_t blockIndex);
+        std::error_code validateTransaction(const CachedTransaction &transaction, TransactionValidatorState &state, IBlockchainCache *cache, uint64_t &fee, uint32_t blockIndex,
+                                            std::vector<RingSignatureCheck> *deferredSignatureChecks = nullptr);
+        bool checkRingSignatures(const std::vector<RingSignatureCheck> &signatureChecks) const;
 
         uint32_t findBlockchainSupplement(const std::vector<crypto::Hash> &remoteBlockIds) const;
         bool checkBlockchainSupplement(const std::vector<crypto::Hash> &remoteBlockIds) const;
@@ -215,6 +282,15 @@ namespace mevacoin
         void mergeMainChainSegments();
         void mergeSegments(IBlockchainCache *acceptingSegment, IBlockchainCache *segment);
         TransactionDetails getTransactionDetails(const crypto::Hash &transactionHash, IBlockchainCache *segment, bool foundInPool) const;
+        uint64_t getBlockSizeMedian(IBlockchainCache *segment, uint32_t blockIndex, const crypto::Hash &blockHash,
+                                    const crypto::Hash &prevBlockHash, uint64_t blockSize) const;
+
+        NextBlockState &getNextBlockState(IBlockchainCache *segment, uint32_t previousBlockIndex) const;
+        uint64_t getNextBlockSizeMedian(IBlockchainCache *segment, uint32_t previousBlockIndex) const;
+        uint64_t getTopBlockSizeMedian(IBlockchainCache *segment) const;
+        std::optional<uint64_t> getNextBlockTimestampMedian(IBlockchainCache *segment, uint32_t previousBlockIndex, size_t windowSize) const;
+        uint64_t getNextBlockDifficulty(IBlockchainCache *segment, uint32_t previousBlockIndex, uint8_t blockMajorVersion) const;
+        void advanceNextBlockState(const CachedBlock &block, uint64_t blockSize, uint64_t difficulty);
         void notifyOnSuccess(error::AddBlockErrorCode opResult, uint32_t previousBlockIndex, const CachedBlock &cachedBlock,
                              const IBlockchainCache &cache);
         void copyTransactionsToPool(IBlockchainCache *alt);
@@ -501,6 +501,14 @@ namespace mevacoin
 
         const uint32_t CURRENT_DB_SCHEME_VERSION = 2;
 
+        /* Limits on the blocks buffered in bulk sync mode before they are committed */
+        const size_t BULK_SYNC_MAX_BLOCKS = 1000;
+        const size_t BULK_SYNC_MAX_BUFFER_SIZE = 64 * 1024 * 1024;
+
+        /* Outputs read from the database at a time when indexing the amounts
+           for random output selection */
+        const uint32_t RANDOM_OUTPUTS_INDEX_BATCH_SIZE = 10000;
+
     }
 
     struct DatabaseBlockchainCache::ExtendedPushedBlockInfo
@@ -510,7 +518,7 @@ namespace mevacoin
     };
 
     DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency &curr, IDataBase &dataBase, IBlockchainCacheFactory &blockchainCacheFactory, std::shared_ptr<logging::ILogger> _logger)
-        : currency(curr), database(dataBase), blockchainCacheFactory(blockchainCacheFactory), logger(_logger, "DatabaseBlockchainCache")
+        : currency(curr), database(dataBase, BULK_SYNC_MAX_BLOCKS, BULK_SYNC_MAX_BUFFER_SIZE), blockchainCacheFactory(blockchainCacheFactory), logger(_logger, "DatabaseBlockchainCache")
     {
         DatabaseVersionReadBatch readBatch;
         auto ec = database.read(readBatch);
@@ -536,6 +544,10 @@ namespace mevacoin
             logger(logging::DEBUGGING) << "Current db scheme version: " << *version;
         }
 
+        /* Blocks pushed from here on, including the genesis block below, add
+           their outputs to the indexes themselves */
+        buildRandomOutputsIndexes();
+
         if (getTopBlockIndex() == 0)
         {
             logger(logging::DEBUGGING) << "top block index is nill, add genesis block";
@@ -685,6 +697,8 @@ namespace mevacoin
 
         cutTail(unitsCache, currentTop + 1 - splitBlockIndex);
 
+        removeFromRandomOutputsIndexes(splitBlockIndex);
+
         children.push_back(cache.get());
         logger(logging::TRACE) << "Delete successfull";
 
@@ -922,6 +936,8 @@ namespace mevacoin
                 outputInfo.outputIndex = poi.outputIndex;
 
                 batch.insertKeyOutputInfo(output.amount, globalIndex, outputInfo);
+
+                addToRandomOutputsIndex(randomOutputsIndexes[output.amount], blockIndex, globalIndex, outputInfo.unlockTime);
             }
         }
 
@@ -1665,6 +1681,29 @@ namespace mevacoin
 
     void DatabaseBlockchainCache::save()
     {
+        auto error = database.flush();
+        if (error)
+        {
+            logger(logging::ERROR) << "Failed to write buffered blocks to DB: " << error.message();
+            throw std::system_error(error);
+        }
+    }
+
+    void DatabaseBlockchainCache::setBulkSync(bool bulkSync)
+    {
+        if (bulkSync == database.isBuffering())
+        {
+            return;
+        }
+
+        logger(logging::DEBUGGING) << (bulkSync ? "Entering" : "Leaving") << " bulk sync mode at block index " << getTopBlockIndex();
+
+        auto error = database.setBuffering(bulkSync);
+        if (error)
+        {
+            logger(logging::ERROR) << "Failed to write buffered blocks to DB: " << error.message();
+            throw std::system_error(error);
+        }
     }
 
     void DatabaseBlockchainCache::load()
@@ -1762,69 +1801,160 @@ namespace mevacoin
     std::vector<uint32_t> DatabaseBlockchainCache::getRandomOutsByAmount(uint64_t amount, size_t count,
                                                                          uint32_t blockIndex) const
     {
-        auto batch = BlockchainReadBatch().requestKeyOutputGlobalIndexesCountForAmount(amount);
-        auto result = readDatabase(batch);
-        auto outputsCount = result.getKeyOutputGlobalIndexesCountForAmounts();
-        auto outputsToPick = std::min(static_cast<uint32_t>(count), outputsCount[amount]);
+        uint32_t uppperBlockIndex = 0;
+        if (blockIndex > currency.minedMoneyUnlockWindow())
+        {
+            uppperBlockIndex = blockIndex - currency.minedMoneyUnlockWindow();
+        }
+
+        const auto indexIt = randomOutputsIndexes.find(amount);
+
+        /* No outputs of this amount */
+        if (indexIt == randomOutputsIndexes.end())
+        {
+            return {};
+        }
+
+        const RandomOutputsIndex &index = indexIt->second;
+
+        /* Outputs from blocks up to uppperBlockIndex are old enough to use, and
+           they are the global indexes below the count for the last such block */
+        const auto lastOldEnough = std::upper_bound(index.outputCounts.begin(), index.outputCounts.end(), uppperBlockIndex,
+                                                    [](uint32_t blockIndex, const std::pair<uint32_t, GlobalOutputIndex> &blockOutputs)
+                                                    { return blockIndex < blockOutputs.first; });
+
+        const GlobalOutputIndex outputsCount = lastOldEnough == index.outputCounts.begin() ? 0 : std::prev(lastOldEnough)->second;
 
         std::vector<uint32_t> resultOuts;
-        resultOuts.reserve(outputsToPick);
+        resultOuts.reserve(std::min(count, static_cast<size_t>(outputsCount)));
 
-        ShuffleGenerator<uint32_t> generator(outputsCount[amount]);
+        ShuffleGenerator<uint32_t> generator(outputsCount);
 
-        while (outputsToPick)
+        while (resultOuts.size() < count && !generator.empty())
         {
-            std::vector<uint32_t> globalIndexes;
-            globalIndexes.reserve(outputsToPick);
+            const GlobalOutputIndex globalIndex = generator();
 
-            try
+            const auto unlockTime = index.unlockTimes.find(globalIndex);
+            if (unlockTime != index.unlockTimes.end() && !isTransactionSpendTimeUnlocked(unlockTime->second, blockIndex))
             {
-                for (uint32_t i = 0; i < outputsToPick; ++i, globalIndexes.push_back(generator()))
-                {
-                }
-                // std::generate_n(std::back_inserter(globalIndexes), outputsToPick, generator);
-            }
-            catch (const SequenceEnded &)
-            {
-                logger(logging::TRACE) << "getRandomOutsByAmount: generator reached sequence end";
-                return resultOuts;
+                continue;
             }
 
-            std::vector<PackedOutIndex> outputs;
-            if (extractKeyOtputIndexes(amount, common::ArrayView<uint32_t>(globalIndexes.data(), globalIndexes.size()), outputs) != ExtractOutputKeysResult::SUCCESS)
-            {
-                logger(logging::DEBUGGING) << "getRandomOutsByAmount: failed to extract key output indexes";
-                throw std::runtime_error("Invalid output index"); // TODO: make error code
-            }
+            resultOuts.push_back(globalIndex);
+        }
 
-            std::vector<ExtendedTransactionInfo> transactions;
-            if (!requestExtendedTransactionInfos(outputs, database, transactions))
-            {
-                logger(logging::TRACE) << "getRandomOutsByAmount: requestExtendedTransactionInfos failed";
-                throw std::runtime_error("Error while requesting transactions"); // TODO: make error code
-            }
+        if (resultOuts.size() < count)
+        {
+            logger(logging::TRACE) << "getRandomOutsByAmount: generator reached sequence end";
+        }
 
-            assert(globalIndexes.size() == transactions.size());
+        return resultOuts;
+    }
 
-            uint32_t uppperBlockIndex = 0;
-            if (blockIndex > currency.minedMoneyUnlockWindow())
+    void DatabaseBlockchainCache::buildRandomOutputsIndexes()
+    {
+        const uint32_t amountsCount = readDatabase(BlockchainReadBatch().requestKeyOutputAmountsCount()).getKeyOutputAmountsCount();
+
+        if (amountsCount == 0)
+        {
+            return;
+        }
+
+        logger(logging::INFO) << "Indexing the outputs of " << amountsCount << " amounts for random output selection...";
+
+        BlockchainReadBatch amountsBatch;
+        for (uint32_t amountIndex = 0; amountIndex < amountsCount; amountIndex++)
+        {
+            amountsBatch.requestKeyOutputAmount(amountIndex);
+        }
+
+        const auto amounts = readDatabase(amountsBatch);
+
+        GlobalOutputIndex totalOutputsCount = 0;
+
+        for (const auto &[amountIndex, amount] : amounts.getKeyOutputAmounts())
+        {
+            const GlobalOutputIndex outputsCount = requestKeyOutputGlobalIndexesCountForAmount(amount, database);
+
+            readRandomOutputsIndex(amount, 0, outputsCount, randomOutputsIndexes[amount]);
+
+            totalOutputsCount += outputsCount;
+        }
+
+        logger(logging::INFO) << "Indexed " << totalOutputsCount << " outputs for random output selection";
+    }
+
+    void DatabaseBlockchainCache::readRandomOutputsIndex(Amount amount, GlobalOutputIndex start, GlobalOutputIndex end, RandomOutputsIndex &index) const
+    {
+        for (GlobalOutputIndex batchStart = start; batchStart < end; batchStart += RANDOM_OUTPUTS_INDEX_BATCH_SIZE)
+        {
+            const GlobalOutputIndex batchEnd = std::min(end, batchStart + RANDOM_OUTPUTS_INDEX_BATCH_SIZE);
+
+            BlockchainReadBatch batch;
+            for (GlobalOutputIndex globalIndex = batchStart; globalIndex < batchEnd; ++globalIndex)
             {
-                uppperBlockIndex = blockIndex - currency.minedMoneyUnlockWindow();
+                batch.requestKeyOutputGlobalIndexForAmount(amount, globalIndex).requestKeyOutputInfo(amount, globalIndex);
             }
 
-            for (size_t i = 0; i < transactions.size(); ++i)
+            auto result = readDatabase(batch);
+            const auto &packedOutputs = result.getKeyOutputGlobalIndexesForAmounts();
+            const auto &outputInfos = result.getKeyOutputInfo();
+
+            for (GlobalOutputIndex globalIndex = batchStart; globalIndex < batchEnd; ++globalIndex)
             {
-                if (!isTransactionSpendTimeUnlocked(transactions[i].unlockTime, blockIndex) || transactions[i].blockIndex > uppperBlockIndex)
+                const auto key = std::make_pair(amount, globalIndex);
+                const auto packedOutput = packedOutputs.find(key);
+                const auto outputInfo = outputInfos.find(key);
+
+                if (packedOutput == packedOutputs.end() || outputInfo == outputInfos.end())
                 {
-                    continue;
+                    throw std::runtime_error("Couldn't find key output for amount " + std::to_string(amount) + " with global output index " + std::to_string(globalIndex));
                 }
 
-                resultOuts.push_back(globalIndexes[i]);
-                --outputsToPick;
+                addToRandomOutputsIndex(index, packedOutput->second.blockIndex, globalIndex, outputInfo->second.unlockTime);
             }
         }
+    }
 
-        return resultOuts;
+    void DatabaseBlockchainCache::addToRandomOutputsIndex(RandomOutputsIndex &index, uint32_t blockIndex,
+                                                          GlobalOutputIndex globalIndex, uint64_t unlockTime) const
+    {
+        if (index.outputCounts.empty() || index.outputCounts.back().first != blockIndex)
+        {
+            index.outputCounts.emplace_back(blockIndex, globalIndex + 1);
+        }
+        else
+        {
+            index.outputCounts.back().second = globalIndex + 1;
+        }
+
+        /* Outputs are only picked once minedMoneyUnlockWindow blocks have passed
+           (bar the genesis block), so an unlock height below that never matters */
+        const uint64_t firstUsableBlockIndex = blockIndex == 0 ? 0 : static_cast<uint64_t>(blockIndex) + currency.minedMoneyUnlockWindow();
+
+        if (unlockTime >= currency.maxBlockHeight() || firstUsableBlockIndex + currency.lockedTxAllowedDeltaBlocks() < unlockTime)
+        {
+            index.unlockTimes[globalIndex] = unlockTime;
+        }
+    }
+
+    void DatabaseBlockchainCache::removeFromRandomOutputsIndexes(uint32_t splitBlockIndex)
+    {
+        for (auto &amountIndex : randomOutputsIndexes)
+        {
+            auto &outputCounts = amountIndex.second.outputCounts;
+
+            const auto firstRemoved = std::lower_bound(outputCounts.begin(), outputCounts.end(), splitBlockIndex,
+                                                       [](const std::pair<uint32_t, GlobalOutputIndex> &blockOutputs, uint32_t blockIndex)
+                                                       { return blockOutputs.first < blockIndex; });
+
+            outputCounts.erase(firstRemoved, outputCounts.end());
+
+            const GlobalOutputIndex outputsCount = outputCounts.empty() ? 0 : outputCounts.back().second;
+
+            auto &unlockTimes = amountIndex.second.unlockTimes;
+            unlockTimes.erase(unlockTimes.lower_bound(outputsCount), unlockTimes.end());
+        }
     }
 
     ExtractOutputKeysResult DatabaseBlockchainCache::extractKeyOutputs(
@@ -7,11 +7,14 @@
 
 #pragma once
 
+#include <map>
+
 #include "common/string_view.h"
 #include "currency.h"
 #include "iblockchain_cache.h"
 #include "mevacoin_core/upgrade_manager.h"
 #include <idatabase.h>
+#include <mevacoin_core/buffered_database.h>
 #include <mevacoin_core/blockchain_read_batch.h>
 #include <mevacoin_core/blockchain_write_batch.h>
 #include <mevacoin_core/database_cache_data.h>
@@ -137,6 +140,10 @@ namespace mevacoin
         virtual void save() override;
         virtual void load() override;
 
+        /* Buffers the writes of consecutive blocks in memory, and commits them
+           to the database in one batch */
+        virtual void setBulkSync(bool bulkSync) override;
+
         virtual std::vector<BinaryArray> getRawTransactions(const std::vector<crypto::Hash> &transactions,
                                                             std::vector<crypto::Hash> &missedTransactions) const override;
         virtual std::vector<BinaryArray> getRawTransactions(const std::vector<crypto::Hash> &transactions) const override;
@@ -162,13 +169,33 @@ namespace mevacoin
 
     private:
         const Currency &currency;
-        IDataBase &database;
+        /* All reads and writes go through here, so buffered blocks are visible */
+        mutable BufferedDatabase database;
         IBlockchainCacheFactory &blockchainCacheFactory;
         mutable boost::optional<uint32_t> topBlockIndex;
         mutable boost::optional<crypto::Hash> topBlockHash;
         mutable boost::optional<uint64_t> transactionsCount;
         mutable boost::optional<uint32_t> keyOutputAmountsCount;
         mutable std::unordered_map<Amount, int32_t> keyOutputCountsForAmounts;
+
+        /* What getRandomOutsByAmount() needs to know about the key outputs of
+           an amount, so it doesn't have to look each candidate up */
+        struct RandomOutputsIndex
+        {
+            /* One entry per block with outputs of this amount: the block index,
+               and the number of outputs of this amount up to and including
+               that block. Global indexes are handed out in block order, so
+               those outputs are global indexes 0 to the number minus one */
+            std::vector<std::pair<uint32_t, GlobalOutputIndex>> outputCounts;
+
+            /* Unlock times of the outputs that may still be locked once they
+               are old enough to use, by global index */
+            std::map<GlobalOutputIndex, uint64_t> unlockTimes;
+        };
+
+        /* Built for every amount when the cache is opened, and kept up to date
+           as blocks are pushed and split off */
+        std::unordered_map<Amount, RandomOutputsIndex> randomOutputsIndexes;
         std::vector<IBlockchainCache *> children;
         logging::LoggerRef logger;
         std::deque<CachedBlockInfo> unitsCache;
@@ -189,6 +216,11 @@ namespace mevacoin
 
         uint32_t insertKeyOutputToGlobalIndex(uint64_t amount, PackedOutIndex output); // TODO not implemented. Should it be removed?
         uint32_t updateKeyOutputCount(Amount amount, int32_t diff) const;
+
+        void buildRandomOutputsIndexes();
+        void readRandomOutputsIndex(Amount amount, GlobalOutputIndex start, GlobalOutputIndex end, RandomOutputsIndex &index) const;
+        void addToRandomOutputsIndex(RandomOutputsIndex &index, uint32_t blockIndex, GlobalOutputIndex globalIndex, uint64_t unlockTime) const;
+        void removeFromRandomOutputsIndexes(uint32_t splitBlockIndex);
         void insertPaymentId(BlockchainWriteBatch &batch, const crypto::Hash &transactionHash, const crypto::Hash &paymentId);
         void insertBlockTimestamp(BlockchainWriteBatch &batch, uint64_t timestamp, const crypto::Hash &blockHash);
 
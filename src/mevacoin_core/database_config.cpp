@@ -6,6 +6,8 @@
 
 #include "database_config.h"
 
+#include <algorithm>
+
 #include <common/util.h>
 #include "common/string_tools.h"
 #include "crypto/crypto.h"
@@ -23,6 +25,13 @@ DataBaseConfig::DataBaseConfig() : dataDir(tools::getDefaultDataDirectory()),
                                    maxOpenFiles(DATABASE_DEFAULT_MAX_OPEN_FILES),
                                    writeBufferSize(DATABASE_WRITE_BUFFER_MB_DEFAULT_SIZE * MEGABYTE),
                                    readCacheSize(DATABASE_READ_BUFFER_MB_DEFAULT_SIZE * MEGABYTE),
+                                   compression(DATABASE_DEFAULT_COMPRESSION),
+                                   bottommostCompression(DATABASE_DEFAULT_BOTTOMMOST_COMPRESSION),
+                                   blockCacheType(DATABASE_DEFAULT_BLOCK_CACHE_TYPE),
+                                   cacheIndexAndFilterBlocks(false),
+                                   highPriorityPoolRatio(DATABASE_DEFAULT_HIGH_PRIORITY_POOL_PERCENT / 100.0),
+                                   pinL0FilterAndIndexBlocks(true),
+                                   statistics(false),
                                    testnet(false),
                                    configFolderDefaulted(false)
 {
@@ -44,6 +53,25 @@ bool DataBaseConfig::init(const std::string dataDirectory, const int backgroundT
     return true;
 }
 
+void DataBaseConfig::setCompression(const std::string &upperLevelsCompression, const std::string &bottommostLevelCompression)
+{
+    compression = upperLevelsCompression;
+    bottommostCompression = bottommostLevelCompression;
+}
+
+void DataBaseConfig::setBlockCache(const std::string &type, const bool cacheIndexAndFilter, const int highPriorityPoolPercent, const bool pinL0FilterAndIndex)
+{
+    blockCacheType = type;
+    cacheIndexAndFilterBlocks = cacheIndexAndFilter;
+    highPriorityPoolRatio = std::min(std::max(highPriorityPoolPercent, 0), 100) / 100.0;
+    pinL0FilterAndIndexBlocks = pinL0FilterAndIndex;
+}
+
+void DataBaseConfig::setStatistics(const bool enable)
+{
+    statistics = enable;
+}
+
 bool DataBaseConfig::isConfigFolderDefaulted() const
 {
     return configFolderDefaulted;
@@ -74,6 +102,41 @@ uint64_t DataBaseConfig::getReadCacheSize() const
     return readCacheSize;
 }
 
+std::string DataBaseConfig::getCompression() const
+{
+    return compression;
+}
+
+std::string DataBaseConfig::getBottommostCompression() const
+{
+    return bottommostCompression;
+}
+
+std::string DataBaseConfig::getBlockCacheType() const
+{
+    return blockCacheType;
+}
+
+bool DataBaseConfig::getCacheIndexAndFilterBlocks() const
+{
+    return cacheIndexAndFilterBlocks;
+}
+
+double DataBaseConfig::getHighPriorityPoolRatio() const
+{
+    return highPriorityPoolRatio;
+}
+
+bool DataBaseConfig::getPinL0FilterAndIndexBlocks() const
+{
+    return pinL0FilterAndIndexBlocks;
+}
+
+bool DataBaseConfig::getStatistics() const
+{
+    return statistics;
+}
+
 bool DataBaseConfig::getTestnet() const
 {
     return testnet;
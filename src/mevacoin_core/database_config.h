@@ -19,12 +19,29 @@ namespace mevacoin
         DataBaseConfig();
         bool init(const std::string dataDirectory, const int backgroundThreads, const int maxOpenFiles, const int writeBufferSizeMB, const int readCacheSizeMB);
 
+        /* Compression names are "auto", "none", "snappy", "lz4" or "zstd" */
+        void setCompression(const std::string &upperLevelsCompression, const std::string &bottommostLevelCompression);
+
+        /* Cache type is "lru" or "clock". Index and filter blocks are only kept in
+           the block cache if cacheIndexAndFilter is set, in which case the high
+           priority pool is the share of the cache reserved for them, in percent */
+        void setBlockCache(const std::string &type, const bool cacheIndexAndFilter, const int highPriorityPoolPercent, const bool pinL0FilterAndIndex);
+
+        void setStatistics(const bool enable);
+
         bool isConfigFolderDefaulted() const;
         std::string getDataDir() const;
         uint16_t getBackgroundThreadsCount() const;
         uint32_t getMaxOpenFiles() const;
         uint64_t getWriteBufferSize() const; // Bytes
         uint64_t getReadCacheSize() const;   // Bytes
+        std::string getCompression() const;
+        std::string getBottommostCompression() const;
+        std::string getBlockCacheType() const;
+        bool getCacheIndexAndFilterBlocks() const;
+        double getHighPriorityPoolRatio() const;
+        bool getPinL0FilterAndIndexBlocks() const;
+        bool getStatistics() const;
         bool getTestnet() const;
 
     private:
@@ -34,6 +51,13 @@ namespace mevacoin
         uint32_t maxOpenFiles;
         uint64_t writeBufferSize;
         uint64_t readCacheSize;
+        std::string compression;
+        std::string bottommostCompression;
+        std::string blockCacheType;
+        bool cacheIndexAndFilterBlocks;
+        double highPriorityPoolRatio;
+        bool pinL0FilterAndIndexBlocks;
+        bool statistics;
         bool testnet;
     };
 } // namespace mevacoin
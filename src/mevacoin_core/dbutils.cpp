@@ -7,6 +7,10 @@
 
 #include "dbutils.h"
 
+#include <cstring>
+
+#include "serialization/kv_binary_common.h"
+
 namespace
 {
     const std::string RAW_BLOCK_NAME = "raw_block";
@@ -37,5 +41,34 @@ namespace mevacoin
             serializer(value.block, RAW_BLOCK_NAME);
             serializer(value.transactions, RAW_TXS_NAME);
         }
+
+        std::string getKeyPrefix(const std::string &rawKey)
+        {
+            /* serializeKey() produces a portable storage header, the (single
+               byte) root entry count, then the root entry name - the prefix */
+            const size_t nameLengthOffset = sizeof(KVBinaryStorageBlockHeader) + 1;
+
+            if (rawKey.size() <= nameLengthOffset)
+            {
+                return std::string();
+            }
+
+            KVBinaryStorageBlockHeader header;
+            std::memcpy(&header, rawKey.data(), sizeof(header));
+
+            if (header.m_signature_a != PORTABLE_STORAGE_SIGNATUREA || header.m_signature_b != PORTABLE_STORAGE_SIGNATUREB)
+            {
+                return std::string();
+            }
+
+            const size_t nameLength = static_cast<uint8_t>(rawKey[nameLengthOffset]);
+
+            if (rawKey.size() < nameLengthOffset + 1 + nameLength)
+            {
+                return std::string();
+            }
+
+            return rawKey.substr(nameLengthOffset + 1, nameLength);
+        }
     }
 }
@@ -91,6 +91,10 @@ namespace mevacoin
 
         void deserialize(const std::string &serialized, RawBlock &value, const std::string &name);
 
+        /* Returns the prefix a key was serialized with by serializeKey(), or an
+           empty string if the key was not created through it */
+        std::string getKeyPrefix(const std::string &rawKey);
+
         template <class Key, class Value>
         void serializeKeys(std::vector<std::string> &rawKeys, const std::string keyPrefix, const std::unordered_map<Key, Value> &map)
         {
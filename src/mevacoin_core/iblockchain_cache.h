@@ -174,6 +174,10 @@ namespace mevacoin
         virtual void save() = 0;
         virtual void load() = 0;
 
+        /* In bulk sync mode pushed blocks may be committed to storage in batches,
+           rather than one at a time. Leaving it commits anything outstanding */
+        virtual void setBulkSync(bool bulkSync) = 0;
+
         virtual std::vector<uint64_t> getLastUnits(size_t count, uint32_t blockIndex, UseGenesis use,
                                                    std::function<uint64_t(const CachedBlockInfo &)> pred) const = 0;
         virtual std::vector<crypto::Hash> getTransactionHashes() const = 0;
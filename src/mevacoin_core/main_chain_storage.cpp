@@ -7,56 +7,228 @@
 
 #include "main_chain_storage.h"
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
 #include <boost/filesystem.hpp>
 
+#include "common/memory_input_stream.h"
 #include "mevacoin_tools.h"
+#include "mevacoin_serialization.h"
+#include "serialization/binary_input_stream_serializer.h"
 
-namespace mevacoin
+namespace
 {
+    /* The files are grown in big steps, as growing them means remapping them */
+    const uint64_t BLOCKS_FILE_GROWTH = 64 * 1024 * 1024;
+    const uint64_t INDEXES_FILE_GROWTH = 1024 * 1024;
+
+    const uint64_t BLOCK_COUNT_SIZE = sizeof(uint64_t);
+    const uint64_t BLOCK_SIZE_SIZE = sizeof(uint32_t);
+
+    /* (Re)maps the file, growing it to at least minimumSize bytes first */
+    void mapFile(syst::MemoryMappedFile &file, const std::string &path, uint64_t minimumSize)
+    {
+        if (file.isOpened())
+        {
+            file.close();
+        }
+
+        if (!boost::filesystem::exists(path))
+        {
+            std::ofstream(path, std::ios::binary);
+        }
+
+        if (boost::filesystem::file_size(path) < minimumSize)
+        {
+            boost::filesystem::resize_file(path, minimumSize);
+        }
+
+        file.open(path);
+    }
+
+    void reserve(syst::MemoryMappedFile &file, uint64_t size, uint64_t growth)
+    {
+        if (file.size() < size)
+        {
+            const std::string path = file.path();
+            mapFile(file, path, size + growth);
+        }
+    }
+
+    mevacoin::RawBlock deserializeBlock(const uint8_t *data, uint64_t size)
+    {
+        mevacoin::RawBlock rawBlock;
+
+        common::MemoryInputStream stream(data, size);
+        mevacoin::BinaryInputStreamSerializer serializer(stream);
+        serialize(rawBlock, serializer);
+
+        if (!stream.endOfStream() || rawBlock.block.empty())
+        {
+            throw std::runtime_error("Main chain storage contains a corrupted block");
+        }
 
-    const size_t STORAGE_CACHE_SIZE = 100;
+        return rawBlock;
+    }
+}
+
+namespace mevacoin
+{
 
     MainChainStorage::MainChainStorage(const std::string &blocksFilename, const std::string &indexesFilename)
     {
-        if (!storage.open(blocksFilename, indexesFilename, STORAGE_CACHE_SIZE))
+        try
+        {
+            mapFile(indexesFile, indexesFilename, BLOCK_COUNT_SIZE);
+            /* An empty file can't be mapped */
+            mapFile(blocksFile, blocksFilename, 1);
+        }
+        catch (const std::exception &e)
+        {
+            throw std::runtime_error("Failed to load main chain storage: " + blocksFilename + ", " + e.what());
+        }
+
+        uint64_t count;
+        std::memcpy(&count, indexesFile.data(), sizeof(count));
+
+        /* Can't have more blocks than sizes stored */
+        count = std::min(count, (indexesFile.size() - BLOCK_COUNT_SIZE) / BLOCK_SIZE_SIZE);
+
+        offsets.reserve(count + 1);
+        offsets.push_back(0);
+
+        for (uint64_t i = 0; i < count; i++)
         {
-            throw std::runtime_error("Failed to load main chain storage: " + blocksFilename);
+            uint32_t blockSize;
+            std::memcpy(&blockSize, indexesFile.data() + BLOCK_COUNT_SIZE + i * BLOCK_SIZE_SIZE, sizeof(blockSize));
+            offsets.push_back(offsets.back() + blockSize);
         }
+
+        recover();
     }
 
     MainChainStorage::~MainChainStorage()
     {
-        storage.close();
+        closeFiles();
+    }
+
+    void MainChainStorage::recover()
+    {
+        const uint64_t storedCount = offsets.size() - 1;
+
+        /* The files are written through the mapping, so after a crash the count
+           may have reached the disk while the block it covers hasn't, leaving the
+           block past the end of the file or zeroed out */
+        while (offsets.size() > 1 && (offsets.back() > blocksFile.size() || !isBlockReadable(static_cast<uint32_t>(offsets.size() - 2))))
+        {
+            offsets.pop_back();
+        }
+
+        if (offsets.size() - 1 != storedCount)
+        {
+            writeBlockCount(offsets.size() - 1);
+            indexesFile.flush(indexesFile.data(), BLOCK_COUNT_SIZE);
+        }
+    }
+
+    bool MainChainStorage::isBlockReadable(uint32_t index) const
+    {
+        try
+        {
+            getBlockByIndex(index);
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    void MainChainStorage::writeBlockCount(uint64_t count)
+    {
+        std::memcpy(indexesFile.data(), &count, sizeof(count));
+    }
+
+    void MainChainStorage::closeFiles()
+    {
+        const uint64_t blocksSize = offsets.back();
+        const uint64_t indexesSize = BLOCK_COUNT_SIZE + (offsets.size() - 1) * BLOCK_SIZE_SIZE;
+
+        const std::string blocksPath = blocksFile.path();
+        const std::string indexesPath = indexesFile.path();
+
+        std::error_code ignore;
+        blocksFile.close(ignore);
+        indexesFile.close(ignore);
+
+        /* Drop the spare capacity, so the files end where the chain does */
+        boost::system::error_code ignoreResize;
+        boost::filesystem::resize_file(blocksPath, blocksSize, ignoreResize);
+        boost::filesystem::resize_file(indexesPath, indexesSize, ignoreResize);
     }
 
     void MainChainStorage::pushBlock(const RawBlock &rawBlock)
     {
-        storage.push_back(rawBlock);
+        const BinaryArray block = toBinaryArray(rawBlock);
+
+        const uint64_t count = offsets.size() - 1;
+        const uint64_t blockOffset = offsets.back();
+        const uint64_t blockEnd = blockOffset + block.size();
+        const uint64_t sizeOffset = BLOCK_COUNT_SIZE + count * BLOCK_SIZE_SIZE;
+
+        reserve(blocksFile, blockEnd, BLOCKS_FILE_GROWTH);
+        reserve(indexesFile, sizeOffset + BLOCK_SIZE_SIZE, INDEXES_FILE_GROWTH);
+
+        std::memcpy(blocksFile.data() + blockOffset, block.data(), block.size());
+
+        const uint32_t blockSize = static_cast<uint32_t>(block.size());
+        std::memcpy(indexesFile.data() + sizeOffset, &blockSize, sizeof(blockSize));
+
+        /* The block only becomes part of the chain once the count covers it */
+        writeBlockCount(count + 1);
+
+        offsets.push_back(blockEnd);
     }
 
     void MainChainStorage::popBlock()
     {
-        storage.pop_back();
+        if (offsets.size() == 1)
+        {
+            throw std::runtime_error("Can't pop a block from empty main chain storage");
+        }
+
+        offsets.pop_back();
+        writeBlockCount(offsets.size() - 1);
+
+        /* The next block pushed overwrites the popped one, so make the new count
+           durable first. Otherwise a crash could bring the popped block back,
+           with the new block half written over it */
+        indexesFile.flush(indexesFile.data(), BLOCK_COUNT_SIZE);
     }
 
     RawBlock MainChainStorage::getBlockByIndex(uint32_t index) const
     {
-        if (index >= storage.size())
+        if (index >= offsets.size() - 1)
         {
-            throw std::out_of_range("Block index " + std::to_string(index) + " is out of range. Blocks count: " + std::to_string(storage.size()));
+            throw std::out_of_range("Block index " + std::to_string(index) + " is out of range. Blocks count: " + std::to_string(offsets.size() - 1));
         }
 
-        return storage[index];
+        return deserializeBlock(blocksFile.data() + offsets[index], offsets[index + 1] - offsets[index]);
     }
 
     uint32_t MainChainStorage::getBlockCount() const
     {
-        return static_cast<uint32_t>(storage.size());
+        return static_cast<uint32_t>(offsets.size() - 1);
     }
 
     void MainChainStorage::clear()
     {
-        storage.clear();
+        offsets.resize(1);
+        writeBlockCount(0);
+        indexesFile.flush(indexesFile.data(), BLOCK_COUNT_SIZE);
     }
 
     std::unique_ptr<IMainChainStorage> createSwappedMainChainStorage(const std::string &dataDir, const Currency &currency)
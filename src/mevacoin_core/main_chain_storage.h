@@ -7,13 +7,20 @@
 
 #pragma once
 
+#include <vector>
+
 #include "imain_chain_storage.h"
 #include "currency.h"
-#include "swapped_vector.h"
+
+#include "syst/memory_mapped_file.h"
 
 namespace mevacoin
 {
 
+    /* Append only block store. The blocks file is memory mapped and blocks are
+       deserialized straight out of the mapping, the indexes file holds the block
+       count followed by the size of every block. Both files are mapped with spare
+       capacity at the end, so appending a block rarely has to remap them. */
     class MainChainStorage : public IMainChainStorage
     {
     public:
@@ -29,7 +36,22 @@ namespace mevacoin
         virtual void clear() override;
 
     private:
-        mutable SwappedVector<RawBlock> storage;
+        /* Drops blocks at the end of the chain which didn't fully make it to
+           disk before a crash */
+        void recover();
+
+        bool isBlockReadable(uint32_t index) const;
+
+        void writeBlockCount(uint64_t count);
+
+        void closeFiles();
+
+        syst::MemoryMappedFile blocksFile;
+        syst::MemoryMappedFile indexesFile;
+
+        /* Offset of each block in the blocks file, followed by the end of the
+           last block */
+        std::vector<uint64_t> offsets;
     };
 
     std::unique_ptr<IMainChainStorage> createSwappedMainChainStorage(const std::string &dataDir, const Currency &currency);
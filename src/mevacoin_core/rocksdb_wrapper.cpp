@@ -7,12 +7,19 @@
 
 #include "rocksdb_wrapper.h"
 
+#include <algorithm>
+#include <cassert>
+
 #include "rocksdb/cache.h"
+#include "rocksdb/convenience.h"
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/statistics.h"
 #include "rocksdb/table.h"
 #include "rocksdb/db.h"
 #include "rocksdb/utilities/backupable_db.h"
 
 #include "database_errors.h"
+#include "dbutils.h"
 
 using namespace mevacoin;
 using namespace logging;
@@ -21,10 +28,102 @@ namespace
 {
     const std::string DB_NAME = "DB";
     const std::string TESTNET_DB_NAME = "testnet_DB";
+
+    /* Present in the default column family while records are being moved into
+       their own column families, so an interrupted migration is resumed */
+    const std::string COLUMN_FAMILY_MIGRATION_KEY = "column_family_migration";
+
+    const size_t COLUMN_FAMILY_MIGRATION_BATCH_SIZE = 10000;
+
+    struct ColumnFamily
+    {
+        std::string name;
+
+        /* The db:: key prefixes stored in this column family */
+        std::vector<std::string> keyPrefixes;
+
+        /* Mostly read by point lookups that miss, such as checkIfSpent */
+        bool bloomFilter;
+
+        /* Large, rarely read records, worth compressing from level 1 on */
+        bool coldData;
+    };
+
+    /* Anything not listed here, like the db scheme version, stays in the default family.
+       Spelt out rather than using rocksdb::kDefaultColumnFamilyName, which is a global
+       in another translation unit, and may not be constructed yet when this one is */
+    const std::vector<ColumnFamily> COLUMN_FAMILIES = {
+        {"default", {}, false, false},
+        {"key_images", {db::KEY_IMAGE_TO_BLOCK_INDEX_PREFIX, db::BLOCK_INDEX_TO_KEY_IMAGE_PREFIX}, true, false},
+        {"key_outputs", {db::KEY_OUTPUT_AMOUNT_PREFIX, db::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX, db::KEY_OUTPUT_KEY_PREFIX}, true, false},
+        {"blocks", {db::BLOCK_INDEX_TO_TX_HASHES_PREFIX, db::BLOCK_INDEX_TO_TRANSACTION_INFO_PREFIX, db::BLOCK_HASH_TO_BLOCK_INDEX_PREFIX, db::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, db::BLOCK_INDEX_TO_BLOCK_HASH_PREFIX, db::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX, db::TIMESTAMP_TO_BLOCKHASHES_PREFIX}, true, false},
+        {"transactions", {db::TRANSACTION_HASH_TO_TRANSACTION_INFO_PREFIX}, true, true},
+        {"payment_ids", {db::PAYMENT_ID_TO_TX_HASH_PREFIX}, true, false},
+        {"raw_blocks", {db::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX}, false, true},
+    };
+
+    const std::vector<std::pair<std::string, rocksdb::CompressionType>> COMPRESSION_TYPES = {
+        {"none", rocksdb::kNoCompression},
+        {"snappy", rocksdb::kSnappyCompression},
+        {"lz4", rocksdb::kLZ4Compression},
+        {"zstd", rocksdb::kZSTD},
+    };
+
+    const uint64_t MEGABYTE = 1024 * 1024;
+
+    bool isCompressionSupported(const rocksdb::CompressionType type)
+    {
+        const auto supported = rocksdb::GetSupportedCompressions();
+
+        return type == rocksdb::kNoCompression || std::find(supported.begin(), supported.end(), type) != supported.end();
+    }
+
+    /* Used when the configured compression wasn't compiled into this build of rocksdb */
+    rocksdb::CompressionType getBestSupportedCompression()
+    {
+        for (const auto type : {rocksdb::kZSTD, rocksdb::kLZ4Compression, rocksdb::kSnappyCompression})
+        {
+            if (isCompressionSupported(type))
+            {
+                return type;
+            }
+        }
+
+        return rocksdb::kNoCompression;
+    }
+
+    /* What "auto" resolves to. The upper levels are rewritten often, so they
+       prefer the fastest codec, the bottommost level the strongest one */
+    rocksdb::CompressionType getAutoCompression(const bool bottommost)
+    {
+        const auto preferred = bottommost
+                                   ? std::vector<rocksdb::CompressionType>{rocksdb::kZSTD, rocksdb::kLZ4Compression, rocksdb::kSnappyCompression}
+                                   : std::vector<rocksdb::CompressionType>{rocksdb::kLZ4Compression, rocksdb::kSnappyCompression, rocksdb::kZSTD};
+
+        for (const auto type : preferred)
+        {
+            if (isCompressionSupported(type))
+            {
+                return type;
+            }
+        }
+
+        return rocksdb::kNoCompression;
+    }
 }
 
 RocksDBWrapper::RocksDBWrapper(std::shared_ptr<logging::ILogger> logger) : logger(logger, "RocksDBWrapper"), state(NOT_INITIALIZED)
 {
+    columnFamilyByPrefix.fill(0);
+
+    for (size_t i = 0; i < COLUMN_FAMILIES.size(); i++)
+    {
+        for (const auto &prefix : COLUMN_FAMILIES[i].keyPrefixes)
+        {
+            assert(prefix.size() == 1);
+            columnFamilyByPrefix[static_cast<uint8_t>(prefix[0])] = i;
+        }
+    }
 }
 
 RocksDBWrapper::~RocksDBWrapper()
@@ -43,9 +142,26 @@ void RocksDBWrapper::init(const DataBaseConfig &config)
     logger(INFO) << "Opening DB in " << dataDir;
 
     rocksdb::DB *dbPtr;
+    std::vector<rocksdb::ColumnFamilyHandle *> handles;
 
     rocksdb::Options dbOptions = getDBOptions(config);
-    rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, &dbPtr);
+    dbOptions.create_missing_column_families = true;
+
+    if (config.getStatistics())
+    {
+        statistics = rocksdb::CreateDBStatistics();
+        dbOptions.statistics = statistics;
+    }
+
+    const auto descriptors = getColumnFamilyDescriptors(config);
+
+    /* Databases created before column families were introduced only have the default one */
+    std::vector<std::string> existingColumnFamilies;
+    rocksdb::DB::ListColumnFamilies(dbOptions, dataDir, &existingColumnFamilies);
+
+    const bool needsMigration = existingColumnFamilies.size() == 1;
+
+    rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, descriptors, &handles, &dbPtr);
     if (status.ok())
     {
         logger(INFO) << "DB opened in " << dataDir;
@@ -54,7 +170,7 @@ void RocksDBWrapper::init(const DataBaseConfig &config)
     {
         logger(INFO) << "DB not found in " << dataDir << ". Creating new DB...";
         dbOptions.create_if_missing = true;
-        rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, &dbPtr);
+        rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, descriptors, &handles, &dbPtr);
         if (!status.ok())
         {
             logger(ERROR) << "DB Error. DB can't be created in " << dataDir << ". Error: " << status.ToString();
@@ -73,9 +189,203 @@ void RocksDBWrapper::init(const DataBaseConfig &config)
     }
 
     db.reset(dbPtr);
+    columnFamilies = handles;
+
+    std::string migrationMarker;
+    const bool migrationInterrupted = db->Get(rocksdb::ReadOptions(), COLUMN_FAMILY_MIGRATION_KEY, &migrationMarker).ok();
+
+    if (needsMigration || migrationInterrupted)
+    {
+        migrateToColumnFamilies();
+    }
+
     state.store(INITIALIZED);
 }
 
+void RocksDBWrapper::migrateToColumnFamilies()
+{
+    rocksdb::ColumnFamilyHandle *defaultFamily = columnFamilies[0];
+
+    std::unique_ptr<rocksdb::Iterator> iter(db->NewIterator(rocksdb::ReadOptions(), defaultFamily));
+
+    iter->SeekToFirst();
+
+    /* Empty, freshly created database, nothing to do */
+    if (!iter->Valid())
+    {
+        return;
+    }
+
+    logger(INFO) << "Moving DB records into column families, this may take a while...";
+
+    rocksdb::Status status = db->Put(rocksdb::WriteOptions(), defaultFamily, COLUMN_FAMILY_MIGRATION_KEY, "1");
+
+    uint64_t movedRecords = 0;
+
+    rocksdb::WriteBatch batch;
+
+    for (; status.ok() && iter->Valid(); iter->Next())
+    {
+        const std::string key = iter->key().ToString();
+
+        rocksdb::ColumnFamilyHandle *family = getColumnFamily(key);
+
+        if (family == defaultFamily)
+        {
+            continue;
+        }
+
+        /* Both halves of the move are in one batch, so a record is never lost
+           or duplicated if we are interrupted */
+        batch.Put(family, key, iter->value());
+        batch.Delete(defaultFamily, key);
+
+        if (++movedRecords % COLUMN_FAMILY_MIGRATION_BATCH_SIZE == 0)
+        {
+            status = db->Write(rocksdb::WriteOptions(), &batch);
+            batch.Clear();
+
+            if (movedRecords % (COLUMN_FAMILY_MIGRATION_BATCH_SIZE * 100) == 0)
+            {
+                logger(INFO) << "Moved " << movedRecords << " DB records";
+            }
+        }
+    }
+
+    if (status.ok())
+    {
+        status = iter->status();
+    }
+
+    if (status.ok())
+    {
+        batch.Delete(defaultFamily, COLUMN_FAMILY_MIGRATION_KEY);
+        status = db->Write(rocksdb::WriteOptions(), &batch);
+    }
+
+    iter.reset();
+
+    if (!status.ok())
+    {
+        logger(ERROR) << "DB Error. Failed to move records into column families. Error: " << status.ToString();
+        closeColumnFamilies();
+        db.reset();
+        throw std::system_error(make_error_code(mevacoin::error::DataBaseErrorCodes::INTERNAL_ERROR));
+    }
+
+    /* Reclaim the space of the moved records */
+    db->CompactRange(rocksdb::CompactRangeOptions(), defaultFamily, nullptr, nullptr);
+
+    logger(INFO) << "Moved " << movedRecords << " DB records into column families";
+}
+
+void RocksDBWrapper::logStatistics()
+{
+    uint64_t totalSize = 0;
+
+    for (size_t i = 0; i < columnFamilies.size(); i++)
+    {
+        uint64_t size = 0;
+        db->GetIntProperty(columnFamilies[i], "rocksdb.total-sst-files-size", &size);
+        totalSize += size;
+
+        logger(INFO) << "DB statistics: column family " << COLUMN_FAMILIES[i].name << " uses " << size / MEGABYTE << " MB on disk";
+    }
+
+    logger(INFO) << "DB statistics: " << totalSize / MEGABYTE << " MB on disk in total";
+
+    const uint64_t keysRead = statistics->getTickerCount(rocksdb::NUMBER_KEYS_READ) + statistics->getTickerCount(rocksdb::NUMBER_MULTIGET_KEYS_READ);
+    const uint64_t blocksRead = statistics->getTickerCount(rocksdb::BLOCK_CACHE_MISS);
+    const uint64_t cacheHits = statistics->getTickerCount(rocksdb::BLOCK_CACHE_HIT);
+
+    /* Every block cache miss is a block read from disk, so this is the number
+       of disk reads each key lookup cost on average */
+    const double readAmplification = keysRead == 0 ? 0 : static_cast<double>(blocksRead) / keysRead;
+    const double cacheHitRate = blocksRead + cacheHits == 0 ? 0 : static_cast<double>(cacheHits) / (blocksRead + cacheHits);
+
+    logger(INFO) << "DB statistics: " << keysRead << " keys read, " << blocksRead << " blocks read from disk, "
+                 << "read amplification " << readAmplification << ", block cache hit rate " << cacheHitRate
+                 << ", " << statistics->getTickerCount(rocksdb::BLOOM_FILTER_USEFUL) << " reads avoided by bloom filters";
+
+    const uint64_t bytesWritten = statistics->getTickerCount(rocksdb::BYTES_WRITTEN);
+    const uint64_t bytesWrittenToDisk = statistics->getTickerCount(rocksdb::FLUSH_WRITE_BYTES) + statistics->getTickerCount(rocksdb::COMPACT_WRITE_BYTES);
+
+    logger(INFO) << "DB statistics: " << bytesWritten / MEGABYTE << " MB written, " << bytesWrittenToDisk / MEGABYTE
+                 << " MB flushed and compacted, write amplification "
+                 << (bytesWritten == 0 ? 0 : static_cast<double>(bytesWrittenToDisk) / bytesWritten);
+}
+
+rocksdb::CompressionType RocksDBWrapper::getCompressionType(const std::string &name, const bool bottommost)
+{
+    if (name == "auto")
+    {
+        return getAutoCompression(bottommost);
+    }
+
+    const auto it = std::find_if(COMPRESSION_TYPES.begin(), COMPRESSION_TYPES.end(), [&name](const auto &type)
+                                 { return type.first == name; });
+
+    if (it == COMPRESSION_TYPES.end())
+    {
+        throw std::runtime_error("Unknown database compression: " + name);
+    }
+
+    if (!isCompressionSupported(it->second))
+    {
+        const rocksdb::CompressionType fallback = getBestSupportedCompression();
+
+        const auto fallbackName = std::find_if(COMPRESSION_TYPES.begin(), COMPRESSION_TYPES.end(), [fallback](const auto &type)
+                                               { return type.second == fallback; });
+
+        logger(WARNING) << "DB compression " << name << " is not supported by this build, using "
+                        << fallbackName->first << " instead";
+
+        return fallback;
+    }
+
+    return it->second;
+}
+
+std::shared_ptr<rocksdb::Cache> RocksDBWrapper::getBlockCache(const DataBaseConfig &config)
+{
+    const std::string type = config.getBlockCacheType();
+
+    if (type == "clock")
+    {
+        /* The clock cache has no high priority pool, pinning L0 index and filter
+           blocks is what keeps them resident there */
+        std::shared_ptr<rocksdb::Cache> cache = rocksdb::NewClockCache(config.getReadCacheSize());
+
+        if (cache)
+        {
+            return cache;
+        }
+
+        logger(WARNING) << "DB clock cache is not supported by this build, using lru instead";
+    }
+    else if (type != "lru")
+    {
+        throw std::runtime_error("Unknown database cache type: " + type);
+    }
+
+    // index and filter blocks are inserted with high priority, and are only
+    // evicted by data blocks once they outgrow their share of the cache.
+    // Without them in the cache, nothing would use the high priority pool
+    const double highPriorityPoolRatio = config.getCacheIndexAndFilterBlocks() ? config.getHighPriorityPoolRatio() : 0;
+
+    return rocksdb::NewLRUCache(config.getReadCacheSize(), -1, false, highPriorityPoolRatio);
+}
+
+void RocksDBWrapper::closeColumnFamilies()
+{
+    for (auto handle : columnFamilies)
+    {
+        db->DestroyColumnFamilyHandle(handle);
+    }
+
+    columnFamilies.clear();
+}
+
 void RocksDBWrapper::shutdown()
 {
     if (state.load() != INITIALIZED)
@@ -83,9 +393,19 @@ void RocksDBWrapper::shutdown()
         throw std::system_error(make_error_code(mevacoin::error::DataBaseErrorCodes::NOT_INITIALIZED));
     }
 
+    if (statistics)
+    {
+        logStatistics();
+        statistics.reset();
+    }
+
     logger(INFO) << "Closing DB.";
-    db->Flush(rocksdb::FlushOptions());
+    for (auto handle : columnFamilies)
+    {
+        db->Flush(rocksdb::FlushOptions(), handle);
+    }
     db->SyncWAL();
+    closeColumnFamilies();
     db.reset();
     state.store(NOT_INITIALIZED);
 }
@@ -102,7 +422,7 @@ void RocksDBWrapper::destroy(const DataBaseConfig &config)
     logger(WARNING) << "Destroying DB in " << dataDir;
 
     rocksdb::Options dbOptions = getDBOptions(config);
-    rocksdb::Status status = rocksdb::DestroyDB(dataDir, dbOptions);
+    rocksdb::Status status = rocksdb::DestroyDB(dataDir, dbOptions, getColumnFamilyDescriptors(config));
 
     if (status.ok())
     {
@@ -134,13 +454,13 @@ std::error_code RocksDBWrapper::write(IWriteBatch &batch, bool sync)
     std::vector<std::pair<std::string, std::string>> rawData(batch.extractRawDataToInsert());
     for (const std::pair<std::string, std::string> &kvPair : rawData)
     {
-        rocksdbBatch.Put(rocksdb::Slice(kvPair.first), rocksdb::Slice(kvPair.second));
+        rocksdbBatch.Put(getColumnFamily(kvPair.first), rocksdb::Slice(kvPair.first), rocksdb::Slice(kvPair.second));
     }
 
     std::vector<std::string> rawKeys(batch.extractRawKeysToRemove());
     for (const std::string &key : rawKeys)
     {
-        rocksdbBatch.Delete(rocksdb::Slice(key));
+        rocksdbBatch.Delete(getColumnFamily(key), rocksdb::Slice(key));
     }
 
     rocksdb::Status status = db->Write(writeOptions, &rocksdbBatch);
@@ -167,15 +487,18 @@ std::error_code RocksDBWrapper::read(IReadBatch &batch)
 
     std::vector<std::string> rawKeys(batch.getRawKeys());
     std::vector<rocksdb::Slice> keySlices;
+    std::vector<rocksdb::ColumnFamilyHandle *> keyFamilies;
     keySlices.reserve(rawKeys.size());
+    keyFamilies.reserve(rawKeys.size());
     for (const std::string &key : rawKeys)
     {
         keySlices.emplace_back(rocksdb::Slice(key));
+        keyFamilies.push_back(getColumnFamily(key));
     }
 
     std::vector<std::string> values;
     values.reserve(rawKeys.size());
-    std::vector<rocksdb::Status> statuses = db->MultiGet(readOptions, keySlices, &values);
+    std::vector<rocksdb::Status> statuses = db->MultiGet(readOptions, keyFamilies, keySlices, &values);
 
     std::error_code error;
     std::vector<bool> resultStates;
@@ -199,42 +522,106 @@ rocksdb::Options RocksDBWrapper::getDBOptions(const DataBaseConfig &config)
     dbOptions.info_log_level = rocksdb::InfoLogLevel::WARN_LEVEL;
     dbOptions.max_open_files = config.getMaxOpenFiles();
 
-    rocksdb::ColumnFamilyOptions fOptions;
-    fOptions.write_buffer_size = static_cast<size_t>(config.getWriteBufferSize());
-    // merge two memtables when flushing to L0
-    fOptions.min_write_buffer_number_to_merge = 2;
-    // this means we'll use 50% extra memory in the worst case, but will reduce
-    // write stalls.
-    fOptions.max_write_buffer_number = 6;
-    // start flushing L0->L1 as soon as possible. each file on level0 is
-    // (memtable_memory_budget / 2). This will flush level 0 when it's bigger than
-    // memtable_memory_budget.
-    fOptions.level0_file_num_compaction_trigger = 20;
-
-    fOptions.level0_slowdown_writes_trigger = 30;
-    fOptions.level0_stop_writes_trigger = 40;
-
-    // doesn't really matter much, but we don't want to create too many files
-    fOptions.target_file_size_base = config.getWriteBufferSize() / 10;
-    // make Level1 size equal to Level0 size, so that L0->L1 compactions are fast
-    fOptions.max_bytes_for_level_base = config.getWriteBufferSize();
-    fOptions.num_levels = 10;
-    fOptions.target_file_size_multiplier = 2;
-    // level style compaction
-    fOptions.compaction_style = rocksdb::kCompactionStyleLevel;
-
-    fOptions.compression_per_level.resize(fOptions.num_levels);
-    for (int i = 0; i < fOptions.num_levels; ++i)
-    {
-        fOptions.compression_per_level[i] = rocksdb::kNoCompression;
-    }
-
-    rocksdb::BlockBasedTableOptions tableOptions;
-    tableOptions.block_cache = rocksdb::NewLRUCache(config.getReadCacheSize());
-    std::shared_ptr<rocksdb::TableFactory> tfp(NewBlockBasedTableFactory(tableOptions));
-    fOptions.table_factory = tfp;
-
-    return rocksdb::Options(dbOptions, fOptions);
+    // the memtables of all column families share the budget a single
+    // column family used to have
+    dbOptions.db_write_buffer_size = static_cast<size_t>(config.getWriteBufferSize()) * 6;
+    // small column families rarely fill a memtable, don't let them pin the WAL forever
+    dbOptions.max_total_wal_size = config.getWriteBufferSize() * 4;
+
+    return rocksdb::Options(dbOptions, rocksdb::ColumnFamilyOptions());
+}
+
+std::vector<rocksdb::ColumnFamilyDescriptor> RocksDBWrapper::getColumnFamilyDescriptors(const DataBaseConfig &config)
+{
+    // one block cache for all column families, so the configured size is the total
+    const std::shared_ptr<rocksdb::Cache> blockCache = getBlockCache(config);
+
+    const rocksdb::CompressionType compression = getCompressionType(config.getCompression(), false);
+    const rocksdb::CompressionType bottommostCompression = getCompressionType(config.getBottommostCompression(), true);
+
+    std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+
+    for (const auto &family : COLUMN_FAMILIES)
+    {
+        rocksdb::ColumnFamilyOptions fOptions;
+        fOptions.write_buffer_size = static_cast<size_t>(config.getWriteBufferSize());
+        // merge two memtables when flushing to L0
+        fOptions.min_write_buffer_number_to_merge = 2;
+        // this means we'll use 50% extra memory in the worst case, but will reduce
+        // write stalls.
+        fOptions.max_write_buffer_number = 6;
+        // start flushing L0->L1 as soon as possible. each file on level0 is
+        // (memtable_memory_budget / 2). This will flush level 0 when it's bigger than
+        // memtable_memory_budget.
+        fOptions.level0_file_num_compaction_trigger = 20;
+
+        fOptions.level0_slowdown_writes_trigger = 30;
+        fOptions.level0_stop_writes_trigger = 40;
+
+        // doesn't really matter much, but we don't want to create too many files
+        fOptions.target_file_size_base = config.getWriteBufferSize() / 10;
+        // make Level1 size equal to Level0 size, so that L0->L1 compactions are fast
+        fOptions.max_bytes_for_level_base = config.getWriteBufferSize();
+        fOptions.num_levels = 10;
+        fOptions.target_file_size_multiplier = 2;
+        // level style compaction
+        fOptions.compaction_style = rocksdb::kCompactionStyleLevel;
+
+        // the upper levels are rewritten often, only compress the colder levels below them
+        const int firstCompressedLevel = family.coldData ? 1 : 2;
+
+        fOptions.compression_per_level.resize(fOptions.num_levels);
+        for (int i = 0; i < fOptions.num_levels; ++i)
+        {
+            fOptions.compression_per_level[i] = i >= firstCompressedLevel ? compression : rocksdb::kNoCompression;
+        }
+
+        // most of the data ends up in the last level, and is rarely rewritten
+        // there, so it is worth the slower, stronger compression
+        fOptions.bottommost_compression = bottommostCompression;
+
+        rocksdb::BlockBasedTableOptions tableOptions;
+        tableOptions.block_cache = blockCache;
+
+        // by default index and filter blocks stay in the table readers, outside
+        // the cache. The chain's are tens of MB, so with the default read cache
+        // they would keep evicting each other, and be read from disk again on
+        // most lookups. With a big enough cache, keeping them in it bounds their
+        // memory, and the high priority pool stops data blocks evicting them.
+        if (config.getCacheIndexAndFilterBlocks())
+        {
+            tableOptions.cache_index_and_filter_blocks = true;
+            tableOptions.cache_index_and_filter_blocks_with_high_priority = true;
+            // L0 files are the most recently written, and the most often read
+            tableOptions.pin_l0_filter_and_index_blocks_in_cache = config.getPinL0FilterAndIndexBlocks();
+        }
+
+        if (family.bloomFilter)
+        {
+            // ~1% false positives, lets lookups of absent keys (unspent key
+            // images, unknown hashes) skip reading data blocks
+            tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
+        }
+
+        std::shared_ptr<rocksdb::TableFactory> tfp(NewBlockBasedTableFactory(tableOptions));
+        fOptions.table_factory = tfp;
+
+        descriptors.emplace_back(family.name, fOptions);
+    }
+
+    return descriptors;
+}
+
+rocksdb::ColumnFamilyHandle *RocksDBWrapper::getColumnFamily(const std::string &rawKey) const
+{
+    const std::string prefix = db::getKeyPrefix(rawKey);
+
+    if (prefix.size() != 1)
+    {
+        return columnFamilies[0];
+    }
+
+    return columnFamilies[columnFamilyByPrefix[static_cast<uint8_t>(prefix[0])]];
 }
 
 std::string RocksDBWrapper::getDataDir(const DataBaseConfig &config)
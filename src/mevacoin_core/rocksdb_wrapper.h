@@ -7,9 +7,11 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "rocksdb/db.h"
 
@@ -44,8 +46,23 @@ namespace mevacoin
         std::error_code write(IWriteBatch &batch, bool sync);
 
         rocksdb::Options getDBOptions(const DataBaseConfig &config);
+        std::vector<rocksdb::ColumnFamilyDescriptor> getColumnFamilyDescriptors(const DataBaseConfig &config);
         std::string getDataDir(const DataBaseConfig &config);
 
+        rocksdb::ColumnFamilyHandle *getColumnFamily(const std::string &rawKey) const;
+
+        rocksdb::CompressionType getCompressionType(const std::string &name, const bool bottommost);
+        std::shared_ptr<rocksdb::Cache> getBlockCache(const DataBaseConfig &config);
+
+        /* Logs the on disk size of each column family, and the read and write
+           amplification seen since the DB was opened */
+        void logStatistics();
+
+        /* Moves records written by older versions, which kept everything in the
+           default column family, into their dedicated column families */
+        void migrateToColumnFamilies();
+        void closeColumnFamilies();
+
         enum State
         {
             NOT_INITIALIZED,
@@ -54,6 +71,16 @@ namespace mevacoin
 
         logging::LoggerRef logger;
         std::unique_ptr<rocksdb::DB> db;
+
+        /* Indexed the same way as the column family table in rocksdb_wrapper.cpp */
+        std::vector<rocksdb::ColumnFamilyHandle *> columnFamilies;
+
+        /* Index of the column family each key prefix lives in */
+        std::array<size_t, 256> columnFamilyByPrefix;
+
+        /* Only collected when enabled in the config, it slows down every read */
+        std::shared_ptr<rocksdb::Statistics> statistics;
+
         std::atomic<State> state;
     };
 }
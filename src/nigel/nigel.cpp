@@ -7,6 +7,7 @@
 #include <nigel/nigel.h>
 ////////////////////////
 
+#include <common/string_tools.h>
 #include <config/mevacoin_config.h>
 #include <mevacoin_core/mevacoin_tools.h>
 #include <errors/validate_parameters.h>
@@ -52,6 +53,7 @@ void Nigel::swapNode(const std::string daemonHost, const uint16_t daemonPort)
     m_networkBlockCount = 0;
     m_peerCount = 0;
     m_lastKnownHashrate = 0;
+    m_binarySyncSupported = true;
 
     m_daemonHost = daemonHost;
     m_daemonPort = daemonPort;
@@ -72,6 +74,33 @@ std::tuple<bool, std::vector<wallet_types::WalletBlockInfo>> Nigel::getWalletSyn
         {"startHeight", startHeight},
         {"startTimestamp", startTimestamp}};
 
+    if (m_binarySyncSupported)
+    {
+        const auto res = m_httpClient->Post(
+            "/getwalletsyncdata.bin", j.dump(), "application/json");
+
+        if (res && res->status == 200)
+        {
+            mevacoin::COMMAND_RPC_GET_WALLET_SYNC_DATA::response response;
+
+            if (!mevacoin::fromBinaryArray(response, common::asBinaryArray(res->body))
+                || response.status != CORE_RPC_STATUS_OK)
+            {
+                return {false, {}};
+            }
+
+            return {true, std::move(response.items)};
+        }
+
+        /* Daemon doesn't know about the binary endpoint, use JSON from now on */
+        if (!res || res->status != 404)
+        {
+            return {false, {}};
+        }
+
+        m_binarySyncSupported = false;
+    }
+
     const auto res = m_httpClient->Post(
         "/getwalletsyncdata", j.dump(), "application/json");
 
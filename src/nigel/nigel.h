@@ -112,6 +112,11 @@ private:
     /* If we should stop the background thread */
     std::atomic<bool> m_shouldStop = false;
 
+    /* If the daemon can send the wallet sync data in the binary format.
+       Older daemons don't have the endpoint, in which case we fall back to
+       the JSON one until the node is swapped */
+    mutable std::atomic<bool> m_binarySyncSupported = true;
+
     /* The amount of blocks the daemon we're connected to has */
     std::atomic<uint64_t> m_localDaemonBlockCount = 0;
 
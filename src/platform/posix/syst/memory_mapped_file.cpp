@@ -172,6 +172,60 @@ namespace syst
         }
     }
 
+    void MemoryMappedFile::resize(uint64_t size, std::error_code &ec)
+    {
+        assert(isOpened());
+
+        flush(m_data, m_size, ec);
+        if (ec)
+        {
+            return;
+        }
+
+        int result = ::munmap(m_data, static_cast<size_t>(m_size));
+        if (result == -1)
+        {
+            ec = std::error_code(errno, std::system_category());
+            return;
+        }
+
+        m_data = nullptr;
+
+        tools::ScopeExit failExitHandler([this, &ec]
+                                         {
+    ec = std::error_code(errno, std::system_category());
+    std::error_code ignore;
+    close(ignore); });
+
+        result = ::ftruncate(m_file, static_cast<off_t>(size));
+        if (result == -1)
+        {
+            return;
+        }
+
+        m_data = reinterpret_cast<uint8_t *>(::mmap(nullptr, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0));
+        if (m_data == MAP_FAILED)
+        {
+            m_data = nullptr;
+            return;
+        }
+
+        m_size = size;
+        ec = std::error_code();
+
+        failExitHandler.cancel();
+    }
+
+    void MemoryMappedFile::resize(uint64_t size)
+    {
+        std::error_code ec;
+        resize(size, ec);
+        if (ec)
+        {
+            throw std::system_error(ec, "MemoryMappedFile::resize");
+        }
+    }
+
     void MemoryMappedFile::rename(const std::string &newPath, std::error_code &ec)
     {
         assert(isOpened());
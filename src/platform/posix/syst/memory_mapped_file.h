@@ -33,6 +33,11 @@ namespace syst
         uint8_t *data();
         bool isOpened() const;
 
+        /* Grows or shrinks the file in place. The mapping moves, so pointers
+           into the old data are invalidated */
+        void resize(uint64_t size, std::error_code &ec);
+        void resize(uint64_t size);
+
         void rename(const std::string &newPath, std::error_code &ec);
         void rename(const std::string &newPath);
 
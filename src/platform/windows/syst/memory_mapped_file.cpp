@@ -202,6 +202,79 @@ namespace syst
         }
     }
 
+    void MemoryMappedFile::resize(uint64_t size, std::error_code &ec)
+    {
+        assert(isOpened());
+
+        flush(m_data, m_size, ec);
+        if (ec)
+        {
+            return;
+        }
+
+        /* The file can't change size while it is mapped */
+        if (!::UnmapViewOfFile(m_data))
+        {
+            ec = std::error_code(::GetLastError(), std::system_category());
+            return;
+        }
+
+        m_data = nullptr;
+
+        tools::ScopeExit failExitHandler([this, &ec]
+                                         {
+    ec = std::error_code(::GetLastError(), std::system_category());
+    std::error_code ignore;
+    close(ignore); });
+
+        if (!::CloseHandle(m_mappingHandle))
+        {
+            return;
+        }
+
+        m_mappingHandle = INVALID_HANDLE_VALUE;
+
+        LONG distanceToMoveHigh = static_cast<LONG>((size >> 32) & UINT64_C(0xffffffff));
+        DWORD filePointer = ::SetFilePointer(m_fileHandle, static_cast<LONG>(size & UINT64_C(0xffffffff)), &distanceToMoveHigh, FILE_BEGIN);
+        if (filePointer == INVALID_SET_FILE_POINTER)
+        {
+            return;
+        }
+
+        if (!::SetEndOfFile(m_fileHandle))
+        {
+            return;
+        }
+
+        m_mappingHandle = ::CreateFileMapping(m_fileHandle, NULL, PAGE_READWRITE, 0, 0, NULL);
+        if (m_mappingHandle == NULL)
+        {
+            m_mappingHandle = INVALID_HANDLE_VALUE;
+            return;
+        }
+
+        m_data = reinterpret_cast<uint8_t *>(::MapViewOfFile(m_mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+        if (m_data == NULL)
+        {
+            return;
+        }
+
+        m_size = size;
+        ec = std::error_code();
+
+        failExitHandler.cancel();
+    }
+
+    void MemoryMappedFile::resize(uint64_t size)
+    {
+        std::error_code ec;
+        resize(size, ec);
+        if (ec)
+        {
+            throw std::system_error(ec, "MemoryMappedFile::resize");
+        }
+    }
+
     void MemoryMappedFile::rename(const std::string &newPath, std::error_code &ec)
     {
         assert(isOpened());
@@ -50,59 +50,6 @@ namespace mevacoin
         KV_MEMBER(response.status)
     }
 
-    void serialize(BlockFullInfo &blockFullInfo, ISerializer &s)
-    {
-        KV_MEMBER(blockFullInfo.block_id);
-        KV_MEMBER(blockFullInfo.block);
-        s(blockFullInfo.transactions, "txs");
-    }
-
-    void serialize(TransactionPrefixInfo &transactionPrefixInfo, ISerializer &s)
-    {
-        KV_MEMBER(transactionPrefixInfo.txHash);
-        KV_MEMBER(transactionPrefixInfo.txPrefix);
-    }
-
-    void serialize(BlockShortInfo &blockShortInfo, ISerializer &s)
-    {
-        KV_MEMBER(blockShortInfo.blockId);
-        KV_MEMBER(blockShortInfo.block);
-        KV_MEMBER(blockShortInfo.txPrefixes);
-    }
-
-    void serialize(wallet_types::WalletBlockInfo &walletBlockInfo, ISerializer &s)
-    {
-        s(walletBlockInfo.coinbaseTransaction, "coinbaseTX");
-        s(walletBlockInfo.transactions, "transactions");
-        s(walletBlockInfo.blockHeight, "blockHeight");
-        s(walletBlockInfo.blockHash, "blockHash");
-        s(walletBlockInfo.blockTimestamp, "blockTimestamp");
-    }
-
-    void serialize(wallet_types::RawTransaction &rawTransaction, ISerializer &s)
-    {
-        s(rawTransaction.keyInputs, "inputs");
-        s(rawTransaction.paymentID, "paymentID");
-        s(rawTransaction.keyOutputs, "outputs");
-        s(rawTransaction.hash, "hash");
-        s(rawTransaction.transactionPublicKey, "txPublicKey");
-        s(rawTransaction.unlockTime, "unlockTime");
-    }
-
-    void serialize(wallet_types::RawCoinbaseTransaction &rawCoinbaseTransaction, ISerializer &s)
-    {
-        s(rawCoinbaseTransaction.keyOutputs, "outputs");
-        s(rawCoinbaseTransaction.hash, "hash");
-        s(rawCoinbaseTransaction.transactionPublicKey, "txPublicKey");
-        s(rawCoinbaseTransaction.unlockTime, "unlockTime");
-    }
-
-    void serialize(wallet_types::KeyOutput &keyOutput, ISerializer &s)
-    {
-        s(keyOutput.key, "key");
-        s(keyOutput.amount, "amount");
-    }
-
     namespace
     {
 
@@ -130,6 +77,33 @@ namespace mevacoin
             };
         }
 
+        /* Takes a JSON request like jsonMethod(), but replies with the
+           response in the binary serialization format. Keys and hashes take
+           half the space they do as hex, and it's much faster to parse. */
+        template <typename Command>
+        RpcServer::HandlerFunction binaryMethod(bool (RpcServer::*handler)(typename Command::request const &, typename Command::response &))
+        {
+            return [handler](RpcServer *obj, const HttpRequest &request, HttpResponse &response)
+            {
+                boost::value_initialized<typename Command::request> req;
+                boost::value_initialized<typename Command::response> res;
+
+                if (!loadFromJson(static_cast<typename Command::request &>(req), request.getBody()))
+                {
+                    return false;
+                }
+
+                bool result = (obj->*handler)(req, res);
+                for (const auto &cors_domain : obj->getCorsDomains())
+                {
+                    response.addHeader("Access-Control-Allow-Origin", cors_domain);
+                }
+                response.addHeader("Content-Type", "application/octet-stream");
+                response.setBody(common::asString(toBinaryArray(res.data())));
+                return result;
+            };
+        }
+
     }
 
     std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction>> RpcServer::s_handlers = {
@@ -153,6 +127,7 @@ namespace mevacoin
         {"/queryblockslite", {jsonMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false}},
         {"/queryblocksdetailed", {jsonMethod<COMMAND_RPC_QUERY_BLOCKS_DETAILED>(&RpcServer::on_query_blocks_detailed), false}},
         {"/getwalletsyncdata", {jsonMethod<COMMAND_RPC_GET_WALLET_SYNC_DATA>(&RpcServer::on_get_wallet_sync_data), false}},
+        {"/getwalletsyncdata.bin", {binaryMethod<COMMAND_RPC_GET_WALLET_SYNC_DATA>(&RpcServer::on_get_wallet_sync_data), false}},
         {"/get_o_indexes", {jsonMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false}},
         {"/getrandom_outs", {jsonMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs), false}},
         {"/get_pool", {jsonMethod<COMMAND_RPC_GET_POOL>(&RpcServer::onGetPool), false}},
@@ -7,6 +7,8 @@
 #include <sub_wallets/sub_wallet.h>
 /////////////////////////////////
 
+#include <config/mevacoin_config.h>
+
 #include <mevacoin_core/account.h>
 #include <mevacoin_core/mevacoin_basic_impl.h>
 
@@ -115,30 +117,52 @@ void SubWallet::storeTransactionInput(
     }
 
     m_unspentInputs.push_back(input);
+
+    addToBalance(input);
 }
 
+/* Gives the same result as summing the unspent inputs, checking each with
+   utilities::isInputUnlocked() */
 std::tuple<uint64_t, uint64_t> SubWallet::getBalance(
     const uint64_t currentHeight) const
 {
-    uint64_t unlockedBalance = 0;
-
-    uint64_t lockedBalance = 0;
+    /* Inputs unlock this many blocks early, see isInputUnlocked() */
+    const uint64_t unlockedHeight = currentHeight + mevacoin::parameters::MEVACOIN_LOCKED_TX_ALLOWED_DELTA_BLOCKS;
 
-    for (const auto input : m_unspentInputs)
+    /* Move the unlocked sum up or down to the height asked for */
+    if (unlockedHeight > m_unlockedHeight)
     {
-        /* If an unlock height is present, check if the input is unlocked */
-        if (utilities::isInputUnlocked(input.unlockTime, currentHeight))
+        for (auto it = m_amountsByUnlockHeight.upper_bound(m_unlockedHeight);
+             it != m_amountsByUnlockHeight.end() && it->first <= unlockedHeight; ++it)
         {
-            unlockedBalance += input.amount;
+            m_unlockedByHeightBalance += it->second;
         }
-        else
+    }
+    else if (unlockedHeight < m_unlockedHeight)
+    {
+        for (auto it = m_amountsByUnlockHeight.upper_bound(unlockedHeight);
+             it != m_amountsByUnlockHeight.end() && it->first <= m_unlockedHeight; ++it)
         {
-            lockedBalance += input.amount;
+            m_unlockedByHeightBalance -= it->second;
         }
     }
 
+    m_unlockedHeight = unlockedHeight;
+
+    uint64_t unlockedBalance = m_unlockedByHeightBalance;
+
+    const uint64_t currentTimeAdjusted = static_cast<uint64_t>(std::time(nullptr)) + mevacoin::parameters::MEVACOIN_LOCKED_TX_ALLOWED_DELTA_SECONDS;
+
+    for (auto it = m_amountsByUnlockTimestamp.begin();
+         it != m_amountsByUnlockTimestamp.end() && it->first <= currentTimeAdjusted; ++it)
+    {
+        unlockedBalance += it->second;
+    }
+
+    uint64_t lockedBalance = m_unspentBalance - unlockedBalance;
+
     /* Add the locked balance from incoming transactions */
-    for (const auto unconfirmedInput : m_unconfirmedIncomingAmounts)
+    for (const auto &unconfirmedInput : m_unconfirmedIncomingAmounts)
     {
         lockedBalance += unconfirmedInput.amount;
     }
@@ -146,6 +170,73 @@ std::tuple<uint64_t, uint64_t> SubWallet::getBalance(
     return {unlockedBalance, lockedBalance};
 }
 
+void SubWallet::addToBalance(const wallet_types::TransactionInput &input)
+{
+    m_unspentBalance += input.amount;
+
+    m_fusionBucketSizes[fusionBucket(input.amount)]++;
+
+    /* if unlockTime is greater than this amount, it's a timestamp, otherwise
+       it's a block height */
+    if (input.unlockTime >= mevacoin::parameters::MEVACOIN_MAX_BLOCK_NUMBER)
+    {
+        m_amountsByUnlockTimestamp[input.unlockTime] += input.amount;
+        return;
+    }
+
+    m_amountsByUnlockHeight[input.unlockTime] += input.amount;
+
+    if (input.unlockTime <= m_unlockedHeight)
+    {
+        m_unlockedByHeightBalance += input.amount;
+    }
+}
+
+void SubWallet::removeFromBalance(const wallet_types::TransactionInput &input)
+{
+    m_unspentBalance -= input.amount;
+
+    const auto bucket = m_fusionBucketSizes.find(fusionBucket(input.amount));
+
+    if (--bucket->second == 0)
+    {
+        m_fusionBucketSizes.erase(bucket);
+    }
+
+    auto &amounts = input.unlockTime >= mevacoin::parameters::MEVACOIN_MAX_BLOCK_NUMBER
+        ? m_amountsByUnlockTimestamp
+        : m_amountsByUnlockHeight;
+
+    const auto it = amounts.find(input.unlockTime);
+
+    it->second -= input.amount;
+
+    if (it->second == 0)
+    {
+        amounts.erase(it);
+    }
+
+    if (input.unlockTime < mevacoin::parameters::MEVACOIN_MAX_BLOCK_NUMBER
+        && input.unlockTime <= m_unlockedHeight)
+    {
+        m_unlockedByHeightBalance -= input.amount;
+    }
+}
+
+void SubWallet::rebuildBalance()
+{
+    m_unspentBalance = 0;
+    m_unlockedByHeightBalance = 0;
+    m_amountsByUnlockHeight.clear();
+    m_amountsByUnlockTimestamp.clear();
+    m_fusionBucketSizes.clear();
+
+    for (const auto &input : m_unspentInputs)
+    {
+        addToBalance(input);
+    }
+}
+
 void SubWallet::reset(const uint64_t scanHeight)
 {
     m_syncStartTimestamp = 0;
@@ -155,6 +246,8 @@ void SubWallet::reset(const uint64_t scanHeight)
     m_unconfirmedIncomingAmounts.clear();
     m_unspentInputs.clear();
     m_spentInputs.clear();
+
+    rebuildBalance();
 }
 
 bool SubWallet::isPrimaryAddress() const
@@ -196,6 +289,25 @@ bool SubWallet::hasKeyImage(const crypto::KeyImage keyImage) const
     /* Also don't need to check unconfirmed inputs - we can't spend those yet */
 }
 
+std::vector<crypto::KeyImage> SubWallet::getKeyImages() const
+{
+    std::vector<crypto::KeyImage> keyImages;
+
+    keyImages.reserve(m_unspentInputs.size() + m_lockedInputs.size());
+
+    for (const auto &input : m_unspentInputs)
+    {
+        keyImages.push_back(input.keyImage);
+    }
+
+    for (const auto &input : m_lockedInputs)
+    {
+        keyImages.push_back(input.keyImage);
+    }
+
+    return keyImages;
+}
+
 crypto::PublicKey SubWallet::publicSpendKey() const
 {
     return m_publicSpendKey;
@@ -225,6 +337,8 @@ void SubWallet::markInputAsSpent(
         /* Add to the spent inputs vector */
         m_spentInputs.push_back(*it);
 
+        removeFromBalance(*it);
+
         /* Remove from the unspent vector */
         m_unspentInputs.erase(it);
 
@@ -274,6 +388,8 @@ void SubWallet::markInputAsLocked(const crypto::KeyImage keyImage)
     /* Add to the spent inputs vector */
     m_lockedInputs.push_back(*it);
 
+    removeFromBalance(*it);
+
     /* Remove from the unspent vector */
     m_unspentInputs.erase(it);
 }
@@ -319,6 +435,8 @@ void SubWallet::removeForkedInputs(const uint64_t forkHeight)
     {
         m_spentInputs.erase(it, m_spentInputs.end());
     }
+
+    rebuildBalance();
 }
 
 /* Cancelled transactions are transactions we sent, but got cancelled and not
@@ -362,6 +480,8 @@ void SubWallet::removeCancelledTransactions(
     {
         m_unconfirmedIncomingAmounts.erase(it2, m_unconfirmedIncomingAmounts.end());
     }
+
+    rebuildBalance();
 }
 
 std::vector<wallet_types::TxInputAndOwner> SubWallet::getSpendableInputs(
@@ -380,6 +500,22 @@ std::vector<wallet_types::TxInputAndOwner> SubWallet::getSpendableInputs(
     return inputs;
 }
 
+const std::vector<wallet_types::TransactionInput> &SubWallet::unspentInputs() const
+{
+    return m_unspentInputs;
+}
+
+const std::unordered_map<int, uint64_t> &SubWallet::fusionBucketSizes() const
+{
+    return m_fusionBucketSizes;
+}
+
+int SubWallet::fusionBucket(const uint64_t amount)
+{
+    /* i.e. 1337 has 4 digits, 420 has 3 digits */
+    return log10(amount);
+}
+
 uint64_t SubWallet::syncStartHeight() const
 {
     return m_syncStartHeight;
@@ -448,6 +584,8 @@ void SubWallet::fromJSON(const JSONValue &j)
         amount.fromJSON(x);
         m_unconfirmedIncomingAmounts.push_back(amount);
     }
+
+    rebuildBalance();
 }
 
 void SubWallet::toJSON(rapidjson::Writer<rapidjson::StringBuffer> &writer) const
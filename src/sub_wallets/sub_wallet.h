@@ -13,8 +13,12 @@
 
 #include "rapidjson/document.h"
 
+#include <map>
+
 #include <string>
 
+#include <unordered_map>
+
 #include <unordered_set>
 
 #include "wallet_types.h"
@@ -76,6 +80,9 @@ public:
 
     bool hasKeyImage(const crypto::KeyImage keyImage) const;
 
+    /* The key images hasKeyImage() finds, i.e. of unspent and locked inputs */
+    std::vector<crypto::KeyImage> getKeyImages() const;
+
     crypto::PublicKey publicSpendKey() const;
 
     crypto::SecretKey privateSpendKey() const;
@@ -94,6 +101,17 @@ public:
     std::vector<wallet_types::TxInputAndOwner> getSpendableInputs(
         const uint64_t height) const;
 
+    /* All unspent inputs, including those not unlocked yet */
+    const std::vector<wallet_types::TransactionInput> &unspentInputs() const;
+
+    /* The number of unspent inputs in each fusion bucket, including those
+       not unlocked yet */
+    const std::unordered_map<int, uint64_t> &fusionBucketSizes() const;
+
+    /* Fusion transactions take inputs of a similar size - they are put in
+       buckets by their number of digits, minus one */
+    static int fusionBucket(const uint64_t amount);
+
     uint64_t syncStartHeight() const;
 
     uint64_t syncStartTimestamp() const;
@@ -110,6 +128,24 @@ public:
     /////////////////////////////
 
 private:
+    //////////////////////////////
+    /* Private member functions */
+    //////////////////////////////
+
+    /* Update the balance totals when an input is added to / removed from
+       m_unspentInputs */
+    void addToBalance(const wallet_types::TransactionInput &input);
+
+    void removeFromBalance(const wallet_types::TransactionInput &input);
+
+    /* Recalculate the balance totals from m_unspentInputs, after changing
+       it in bulk */
+    void rebuildBalance();
+
+    //////////////////////////////
+    /* Private member variables */
+    //////////////////////////////
+
     /* A vector of the stored transaction input data, to be used for
        sending transactions later */
     std::vector<wallet_types::TransactionInput> m_unspentInputs;
@@ -126,6 +162,29 @@ private:
        balance correctly */
     std::vector<wallet_types::UnconfirmedInput> m_unconfirmedIncomingAmounts;
 
+    /* The sum of the unspent inputs, so getBalance() doesn't have to go
+       through every input every time it's called */
+    uint64_t m_unspentBalance = 0;
+
+    /* The amounts of the unspent inputs, summed by unlock height (zero for
+       inputs which are unlocked straight away) */
+    std::map<uint64_t, uint64_t> m_amountsByUnlockHeight;
+
+    /* The amounts of the unspent inputs which unlock at a timestamp rather
+       than a height - rare */
+    std::map<uint64_t, uint64_t> m_amountsByUnlockTimestamp;
+
+    /* The sum of m_amountsByUnlockHeight up to and including this height.
+       Moved along to the height asked for each time getBalance() is
+       called, which is nearly always the same as or just above the last,
+       hence mutable. */
+    mutable uint64_t m_unlockedHeight = 0;
+
+    mutable uint64_t m_unlockedByHeightBalance = 0;
+
+    /* See fusionBucketSizes(). Kept up to date along with the balance. */
+    std::unordered_map<int, uint64_t> m_fusionBucketSizes;
+
     /* This subwallet's public spend key */
     crypto::PublicKey m_publicSpendKey;
 
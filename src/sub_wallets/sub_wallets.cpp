@@ -13,6 +13,8 @@
 
 #include <ctime>
 
+#include <limits>
+
 #include <mutex>
 
 #include <random>
@@ -20,6 +22,63 @@
 #include <utilities/addresses.h>
 #include <utilities/utilities.h>
 
+/* Anonymous namespace so it doesn't clash with anything else */
+namespace
+{
+
+    /* Gives the numbers 0 to size - 1 in a random order, without making the
+       whole permutation up front. It's a Fisher-Yates shuffle which only
+       stores the positions it has swapped, so taking a few numbers out of a
+       lot is cheap. */
+    class LazyShuffle
+    {
+    public:
+        explicit LazyShuffle(const size_t size) : m_remaining(size)
+        {
+        }
+
+        bool empty() const
+        {
+            return m_remaining == 0;
+        }
+
+        size_t next()
+        {
+            std::uniform_int_distribution<size_t> distribution(0, m_remaining - 1);
+
+            const size_t index = distribution(m_random);
+
+            const size_t last = m_remaining - 1;
+
+            const size_t result = valueAt(index);
+
+            /* Swap the last remaining value into the picked position */
+            m_swapped[index] = valueAt(last);
+            m_swapped.erase(last);
+
+            m_remaining--;
+
+            return result;
+        }
+
+    private:
+        size_t valueAt(const size_t index) const
+        {
+            const auto it = m_swapped.find(index);
+
+            return it == m_swapped.end() ? index : it->second;
+        }
+
+        size_t m_remaining;
+
+        /* Positions which don't hold their own number */
+        std::unordered_map<size_t, size_t> m_swapped;
+
+        std::random_device m_random;
+    };
+
+} // namespace
+
 ///////////////////////////////////
 /* CONSTRUCTORS / DECONSTRUCTORS */
 ///////////////////////////////////
@@ -48,6 +107,8 @@ SubWallets::SubWallets(
         isPrimaryAddress);
 
     m_publicSpendKeys.push_back(publicSpendKey);
+
+    updatePublicSpendKeySet();
 }
 
 /* Makes a new view only subwallet */
@@ -70,17 +131,22 @@ SubWallets::SubWallets(
         publicSpendKey, address, scanHeight, timestamp, isPrimaryAddress);
 
     m_publicSpendKeys.push_back(publicSpendKey);
+
+    updatePublicSpendKeySet();
 }
 
 /* Copy constructor */
 SubWallets::SubWallets(const SubWallets &other) : m_subWallets(other.m_subWallets),
-                                                  m_transactions(other.m_transactions),
                                                   m_lockedTransactions(other.m_lockedTransactions),
                                                   m_privateViewKey(other.m_privateViewKey),
                                                   m_isViewWallet(other.m_isViewWallet),
                                                   m_publicSpendKeys(other.m_publicSpendKeys),
-                                                  m_transactionPrivateKeys(other.m_transactionPrivateKeys)
+                                                  m_transactionPrivateKeys(other.m_transactionPrivateKeys),
+                                                  m_keyImageOwners(other.m_keyImageOwners),
+                                                  m_publicSpendKeySet(other.m_publicSpendKeySet)
 {
+    /* Not shared, we append to it */
+    rebuildTransactionHistory(other.m_transactionHistory->transactions);
 }
 
 /////////////////////
@@ -97,6 +163,8 @@ std::tuple<Error, std::string, crypto::SecretKey> SubWallets::addSubWallet()
 
     std::scoped_lock lock(m_mutex);
 
+    changedOutsideOfSync();
+
     mevacoin::KeyPair spendKey;
 
     /* Generate a spend key */
@@ -115,6 +183,8 @@ std::tuple<Error, std::string, crypto::SecretKey> SubWallets::addSubWallet()
 
     m_publicSpendKeys.push_back(spendKey.publicKey);
 
+    updatePublicSpendKeySet();
+
     return {SUCCESS, address, spendKey.secretKey};
 }
 
@@ -130,6 +200,8 @@ std::tuple<Error, std::string> SubWallets::importSubWallet(
 
     std::scoped_lock lock(m_mutex);
 
+    changedOutsideOfSync();
+
     crypto::PublicKey publicSpendKey;
 
     crypto::secret_key_to_public_key(privateSpendKey, publicSpendKey);
@@ -152,6 +224,8 @@ std::tuple<Error, std::string> SubWallets::importSubWallet(
 
     m_publicSpendKeys.push_back(publicSpendKey);
 
+    updatePublicSpendKeySet();
+
     return {SUCCESS, address};
 }
 
@@ -167,6 +241,8 @@ std::tuple<Error, std::string> SubWallets::importViewSubWallet(
 
     std::scoped_lock lock(m_mutex);
 
+    changedOutsideOfSync();
+
     if (m_subWallets.find(publicSpendKey) != m_subWallets.end())
     {
         return {SUBWALLET_ALREADY_EXISTS, std::string()};
@@ -188,6 +264,8 @@ std::tuple<Error, std::string> SubWallets::importViewSubWallet(
 
     m_publicSpendKeys.push_back(publicSpendKey);
 
+    updatePublicSpendKeySet();
+
     return {SUCCESS, address};
 }
 
@@ -195,6 +273,8 @@ Error SubWallets::deleteSubWallet(const std::string address)
 {
     std::scoped_lock lock(m_mutex);
 
+    changedOutsideOfSync();
+
     const auto [spendKey, viewKey] = utilities::addressToKeys(address);
 
     const auto it = m_subWallets.find(spendKey);
@@ -212,8 +292,13 @@ Error SubWallets::deleteSubWallet(const std::string address)
 
     m_subWallets.erase(it);
 
+    rebuildKeyImageOwners();
+
     /* Remove or update the transactions */
-    deleteAddressTransactions(m_transactions, spendKey);
+    auto transactions = m_transactionHistory->transactions;
+    deleteAddressTransactions(transactions, spendKey);
+    rebuildTransactionHistory(std::move(transactions));
+
     deleteAddressTransactions(m_lockedTransactions, spendKey);
 
     const auto it2 = std::remove(m_publicSpendKeys.begin(), m_publicSpendKeys.end(), spendKey);
@@ -223,6 +308,8 @@ Error SubWallets::deleteSubWallet(const std::string address)
         m_publicSpendKeys.erase(it2, m_publicSpendKeys.end());
     }
 
+    updatePublicSpendKeySet();
+
     return SUCCESS;
 }
 
@@ -314,6 +401,8 @@ void SubWallets::addUnconfirmedTransaction(const wallet_types::Transaction tx)
 {
     std::scoped_lock lock(m_mutex);
 
+    changedOutsideOfSync();
+
     const auto it2 = std::find_if(m_lockedTransactions.begin(), m_lockedTransactions.end(),
                                   [tx](const auto transaction)
                                   {
@@ -350,15 +439,13 @@ void SubWallets::addTransaction(const wallet_types::Transaction tx)
     {
         /* Remove from the locked container */
         m_lockedTransactions.erase(it, m_lockedTransactions.end());
+
+        m_lockedTransactionsChanged = true;
     }
 
-    const auto it2 = std::find_if(m_transactions.begin(), m_transactions.end(),
-                                  [tx](const auto transaction)
-                                  {
-                                      return tx.hash == transaction.hash;
-                                  });
+    auto &history = *m_transactionHistory;
 
-    if (it2 != m_transactions.end())
+    if (history.byHash.find(tx.hash) != history.byHash.end())
     {
         std::stringstream stream;
 
@@ -367,7 +454,36 @@ void SubWallets::addTransaction(const wallet_types::Transaction tx)
         throw std::runtime_error(stream.str());
     }
 
-    m_transactions.push_back(tx);
+    /* Transactions come in block order when syncing, anything else has to
+       be put in its place, moving the ones after it */
+    if (!history.transactions.empty() && tx.blockHeight < history.transactions.back().blockHeight)
+    {
+        auto transactions = history.transactions;
+        transactions.push_back(tx);
+        rebuildTransactionHistory(std::move(transactions));
+    }
+    else
+    {
+        std::unique_lock historyLock(history.mutex);
+
+        const size_t position = history.transactions.size();
+
+        history.transactions.push_back(tx);
+        history.byHash[tx.hash] = position;
+
+        for (const auto &[publicKey, amount] : tx.transfers)
+        {
+            history.byPublicSpendKey[publicKey].push_back(position);
+        }
+    }
+
+    if (!m_journalInvalidated)
+    {
+        JournalEntry entry;
+        entry.type = JournalEntry::ADD_TRANSACTION;
+        entry.transaction = tx;
+        m_journal.push_back(entry);
+    }
 }
 
 crypto::KeyImage SubWallets::getTxInputKeyImage(
@@ -401,6 +517,21 @@ void SubWallets::storeTransactionInput(
     /* Check it exists */
     if (it != m_subWallets.end())
     {
+        /* View wallets don't have key images to track */
+        if (!m_isViewWallet)
+        {
+            m_keyImageOwners[input.keyImage] = publicSpendKey;
+        }
+
+        if (!m_journalInvalidated)
+        {
+            JournalEntry entry;
+            entry.type = JournalEntry::STORE_INPUT;
+            entry.publicSpendKey = publicSpendKey;
+            entry.input = input;
+            m_journal.push_back(entry);
+        }
+
         /* If we have a view wallet, don't attempt to derive the key image */
         return it->second.storeTransactionInput(input, m_isViewWallet);
     }
@@ -419,12 +550,11 @@ SubWallets::getKeyImageOwner(const crypto::KeyImage keyImage) const
 
     std::scoped_lock lock(m_mutex);
 
-    for (const auto &[publicKey, subWallet] : m_subWallets)
+    const auto it = m_keyImageOwners.find(keyImage);
+
+    if (it != m_keyImageOwners.end())
     {
-        if (subWallet.hasKeyImage(keyImage))
-        {
-            return {true, subWallet.publicSpendKey()};
-        }
+        return {true, it->second};
     }
 
     return {false, crypto::PublicKey()};
@@ -454,38 +584,54 @@ SubWallets::getTransactionInputsForAmount(
         subWalletsToTakeFrom = m_publicSpendKeys;
     }
 
-    std::vector<SubWallet> wallets;
+    std::vector<const SubWallet *> wallets;
+
+    /* Where each wallet's inputs start, when numbering the inputs of every
+       wallet in turn */
+    std::vector<size_t> walletOffsets;
+
+    size_t inputCount = 0;
 
     /* Loop through each public key and grab the associated wallet */
     for (const auto &publicKey : subWalletsToTakeFrom)
     {
-        wallets.push_back(m_subWallets.at(publicKey));
-    }
-
-    std::vector<wallet_types::TxInputAndOwner> availableInputs;
+        const SubWallet &subWallet = m_subWallets.at(publicKey);
 
-    /* Copy the transaction inputs from this sub wallet to inputs */
-    for (const auto &subWallet : wallets)
-    {
-        const auto moreInputs = subWallet.getSpendableInputs(height);
+        wallets.push_back(&subWallet);
+        walletOffsets.push_back(inputCount);
 
-        availableInputs.insert(availableInputs.end(), moreInputs.begin(), moreInputs.end());
+        inputCount += subWallet.unspentInputs().size();
     }
 
-    /* Shuffle the inputs */
-    std::shuffle(availableInputs.begin(), availableInputs.end(), std::random_device{});
+    /* Rather than copying every spendable input and shuffling them, pick
+       inputs at random till we have enough. This gives the same selection
+       as taking them from the front of a shuffled list. */
+    LazyShuffle shuffle(inputCount);
 
     uint64_t foundMoney = 0;
 
     std::vector<wallet_types::TxInputAndOwner> inputsToUse;
 
-    /* Loop through each input */
-    for (const auto walletAmount : availableInputs)
+    while (!shuffle.empty())
     {
+        const size_t index = shuffle.next();
+
+        /* Find the wallet this input belongs to */
+        const size_t walletIndex = std::upper_bound(walletOffsets.begin(), walletOffsets.end(), index) - walletOffsets.begin() - 1;
+
+        const SubWallet &subWallet = *wallets[walletIndex];
+
+        const auto &input = subWallet.unspentInputs()[index - walletOffsets[walletIndex]];
+
+        if (!utilities::isInputUnlocked(input.unlockTime, height))
+        {
+            continue;
+        }
+
         /* Add each input */
-        inputsToUse.push_back(walletAmount);
+        inputsToUse.emplace_back(input, subWallet.publicSpendKey(), subWallet.privateSpendKey());
 
-        foundMoney += walletAmount.input.amount;
+        foundMoney += input.amount;
 
         /* Keep adding until we have enough money for the transaction */
         if (foundMoney >= amount)
@@ -519,22 +665,22 @@ SubWallets::getFusionTransactionInputs(
         subWalletsToTakeFrom = m_publicSpendKeys;
     }
 
-    std::vector<SubWallet> wallets;
+    std::vector<const SubWallet *> wallets;
+
+    /* The number of unspent inputs in each bucket */
+    std::unordered_map<int, uint64_t> bucketSizes;
 
     /* Loop through each public key and grab the associated wallet */
     for (const auto &publicKey : subWalletsToTakeFrom)
     {
-        wallets.push_back(m_subWallets.at(publicKey));
-    }
-
-    std::vector<wallet_types::TxInputAndOwner> availableInputs;
+        const SubWallet &subWallet = m_subWallets.at(publicKey);
 
-    /* Copy the transaction inputs from this sub wallet to inputs */
-    for (const auto &subWallet : wallets)
-    {
-        const auto moreInputs = subWallet.getSpendableInputs(height);
+        wallets.push_back(&subWallet);
 
-        availableInputs.insert(availableInputs.end(), moreInputs.begin(), moreInputs.end());
+        for (const auto &[bucket, size] : subWallet.fusionBucketSizes())
+        {
+            bucketSizes[bucket] += size;
+        }
     }
 
     /* Get an approximation of the max amount of inputs we can include in this
@@ -544,51 +690,81 @@ SubWallets::getFusionTransactionInputs(
         mevacoin::parameters::FUSION_TX_MIN_IN_OUT_COUNT_RATIO,
         mixin);
 
-    /* Shuffle the inputs */
-    std::shuffle(availableInputs.begin(), availableInputs.end(), std::random_device{});
+    /* Buckets which can be full, going by the number of unspent inputs.
+       Some of those inputs may not be unlocked yet though. */
+    std::unordered_set<int> possiblyFullBuckets;
 
-    /* Split the inputs into buckets based on what power of ten they are in
-       (For example, [1, 2, 5, 7], [20, 50, 80, 80], [100, 600, 700]) */
-    std::unordered_map<uint64_t, std::vector<wallet_types::TxInputAndOwner>> buckets;
+    for (const auto &[bucket, size] : bucketSizes)
+    {
+        if (size >= mevacoin::parameters::FUSION_TX_MIN_INPUT_COUNT)
+        {
+            possiblyFullBuckets.insert(bucket);
+        }
+    }
 
-    for (const auto &walletAmount : availableInputs)
+    /* Split the spendable inputs into buckets based on what power of ten they
+       are in (For example, [1, 2, 5, 7], [20, 50, 80, 80], [100, 600, 700]).
+       If onlyPossiblyFull is set, the inputs of buckets which can't be full
+       are skipped. */
+    const auto bucketInputs = [&](const bool onlyPossiblyFull)
     {
-        /* Find out how many digits the amount has, i.e. 1337 has 4 digits,
-           420 has 3 digits */
-        int numberOfDigits = log10(walletAmount.input.amount);
+        std::unordered_map<int, std::vector<std::pair<const wallet_types::TransactionInput *, const SubWallet *>>> buckets;
 
-        /* Insert the amount into the correct bucket */
-        buckets[numberOfDigits].push_back(walletAmount);
-    }
+        for (const auto subWallet : wallets)
+        {
+            for (const auto &input : subWallet->unspentInputs())
+            {
+                const int bucket = SubWallet::fusionBucket(input.amount);
+
+                if (onlyPossiblyFull && possiblyFullBuckets.find(bucket) == possiblyFullBuckets.end())
+                {
+                    continue;
+                }
+
+                if (utilities::isInputUnlocked(input.unlockTime, height))
+                {
+                    buckets[bucket].emplace_back(&input, subWallet);
+                }
+            }
+        }
+
+        return buckets;
+    };
+
+    /* Only look at the buckets which can be full to begin with */
+    auto buckets = bucketInputs(true);
 
     /* Find the buckets which have enough inputs to meet the fusion tx
        requirements */
-    std::vector<std::vector<wallet_types::TxInputAndOwner>> fullBuckets;
+    std::vector<int> fullBuckets;
 
-    for (const auto [amount, bucket] : buckets)
+    for (const auto &[bucket, inputs] : buckets)
     {
         /* Skip the buckets with not enough items */
-        if (bucket.size() >= mevacoin::parameters::FUSION_TX_MIN_INPUT_COUNT)
+        if (inputs.size() >= mevacoin::parameters::FUSION_TX_MIN_INPUT_COUNT)
         {
             fullBuckets.push_back(bucket);
         }
     }
 
-    /* Shuffle the full buckets */
-    std::shuffle(fullBuckets.begin(), fullBuckets.end(), std::random_device{});
+    std::random_device random;
 
     /* The buckets to pick inputs from */
-    std::vector<std::vector<wallet_types::TxInputAndOwner>> bucketsToTakeFrom;
+    std::vector<int> bucketsToTakeFrom;
 
-    /* We have full buckets, take the first full bucket */
+    /* We have full buckets, take a random full bucket */
     if (!fullBuckets.empty())
     {
-        bucketsToTakeFrom = {fullBuckets.front()};
+        std::uniform_int_distribution<size_t> distribution(0, fullBuckets.size() - 1);
+
+        bucketsToTakeFrom = {fullBuckets[distribution(random)]};
     }
     /* Otherwise just use all buckets */
     else
     {
-        for (const auto [amount, bucket] : buckets)
+        buckets = bucketInputs(false);
+
+        for (const auto &[bucket, inputs] : buckets)
         {
             bucketsToTakeFrom.push_back(bucket);
         }
@@ -602,13 +778,22 @@ SubWallets::getFusionTransactionInputs(
        we've got a full bucket) */
     for (const auto bucket : bucketsToTakeFrom)
     {
-        /* Loop through each input in this bucket */
-        for (const auto &walletAmount : bucket)
+        auto &inputs = buckets[bucket];
+
+        /* Take inputs from this bucket at random - shuffling only as much of
+           it as we take */
+        for (size_t i = 0; i < inputs.size(); i++)
         {
+            std::uniform_int_distribution<size_t> distribution(i, inputs.size() - 1);
+
+            std::swap(inputs[i], inputs[distribution(random)]);
+
+            const auto [input, subWallet] = inputs[i];
+
             /* Add each input */
-            inputsToUse.push_back(walletAmount);
+            inputsToUse.emplace_back(*input, subWallet->publicSpendKey(), subWallet->privateSpendKey());
 
-            foundMoney += walletAmount.input.amount;
+            foundMoney += input->amount;
 
             /* Got enough inputs, return */
             if (inputsToUse.size() >= maxInputsToTake)
@@ -625,30 +810,32 @@ SubWallets::getFusionTransactionInputs(
    wallet */
 std::string SubWallets::getPrimaryAddress() const
 {
-    std::scoped_lock lock(m_mutex);
+    const auto snapshot = getSnapshot(std::nullopt);
 
-    const auto it =
-        std::find_if(m_subWallets.begin(), m_subWallets.end(), [](const auto subWallet)
-                     { return subWallet.second.isPrimaryAddress(); });
-
-    if (it == m_subWallets.end())
+    if (snapshot->primaryAddress.empty())
     {
         throw std::runtime_error("This container has no primary address!");
     }
 
-    return it->second.address();
+    return snapshot->primaryAddress;
 }
 
 std::vector<std::string> SubWallets::getAddresses() const
 {
-    std::vector<std::string> addresses;
+    return getSnapshot(std::nullopt)->addresses;
+}
 
-    for (const auto [pubKey, subWallet] : m_subWallets)
-    {
-        addresses.push_back(subWallet.address());
-    }
+std::shared_ptr<const std::unordered_set<crypto::PublicKey>> SubWallets::getPublicSpendKeySet() const
+{
+    std::scoped_lock lock(m_mutex);
 
-    return addresses;
+    return m_publicSpendKeySet;
+}
+
+void SubWallets::updatePublicSpendKeySet()
+{
+    m_publicSpendKeySet = std::make_shared<const std::unordered_set<crypto::PublicKey>>(
+        m_publicSpendKeys.begin(), m_publicSpendKeys.end());
 }
 
 uint64_t SubWallets::getWalletCount() const
@@ -662,22 +849,22 @@ std::tuple<uint64_t, uint64_t> SubWallets::getBalance(
     const bool takeFromAll,
     const uint64_t currentHeight) const
 {
-    std::scoped_lock lock(m_mutex);
+    const auto snapshot = getSnapshot(currentHeight);
 
     /* If we're able to take from every subwallet, set the wallets to take from
        to all our public spend keys */
     if (takeFromAll)
     {
-        subWalletsToTakeFrom = m_publicSpendKeys;
+        subWalletsToTakeFrom = snapshot->publicSpendKeys;
     }
 
     uint64_t unlockedBalance = 0;
 
     uint64_t lockedBalance = 0;
 
-    for (const auto pubKey : subWalletsToTakeFrom)
+    for (const auto &pubKey : subWalletsToTakeFrom)
     {
-        const auto [unlocked, locked] = m_subWallets.at(pubKey).getBalance(currentHeight);
+        const auto [unlocked, locked] = snapshot->balances.at(pubKey);
 
         unlockedBalance += unlocked;
         lockedBalance += locked;
@@ -699,6 +886,18 @@ void SubWallets::markInputAsSpent(
     std::scoped_lock lock(m_mutex);
 
     m_subWallets.at(publicKey).markInputAsSpent(keyImage, spendHeight);
+
+    m_keyImageOwners.erase(keyImage);
+
+    if (!m_journalInvalidated)
+    {
+        JournalEntry entry;
+        entry.type = JournalEntry::SPEND_INPUT;
+        entry.publicSpendKey = publicKey;
+        entry.keyImage = keyImage;
+        entry.spendHeight = spendHeight;
+        m_journal.push_back(entry);
+    }
 }
 
 /* Mark a key image as locked, can no longer be used in transactions till it
@@ -713,6 +912,8 @@ void SubWallets::markInputAsLocked(
 
     std::scoped_lock lock(m_mutex);
 
+    changedOutsideOfSync();
+
     m_subWallets.at(publicKey).markInputAsLocked(keyImage);
 }
 
@@ -721,16 +922,34 @@ void SubWallets::removeForkedTransactions(uint64_t forkHeight)
 {
     std::scoped_lock lock(m_mutex);
 
-    const auto it = std::remove_if(m_transactions.begin(), m_transactions.end(),
-                                   [forkHeight](auto tx)
-                                   {
-                                       /* Remove the transaction if it's height is >= than the fork height */
-                                       return tx.blockHeight >= forkHeight;
-                                   });
+    changedOutsideOfSync();
 
-    if (it != m_transactions.end())
     {
-        m_transactions.erase(it, m_transactions.end());
+        auto &history = *m_transactionHistory;
+
+        std::unique_lock historyLock(history.mutex);
+
+        /* They're ordered by height, so the forked ones are at the end */
+        while (!history.transactions.empty() && history.transactions.back().blockHeight >= forkHeight)
+        {
+            const auto &tx = history.transactions.back();
+
+            history.byHash.erase(tx.hash);
+
+            for (const auto &[publicKey, amount] : tx.transfers)
+            {
+                auto &positions = history.byPublicSpendKey[publicKey];
+
+                positions.pop_back();
+
+                if (positions.empty())
+                {
+                    history.byPublicSpendKey.erase(publicKey);
+                }
+            }
+
+            history.transactions.pop_back();
+        }
     }
 
     /* Loop through each subwallet */
@@ -738,6 +957,10 @@ void SubWallets::removeForkedTransactions(uint64_t forkHeight)
     {
         subWallet.removeForkedInputs(forkHeight);
     }
+
+    /* Forked inputs are gone, locked inputs are dropped, and inputs spent
+       after the fork are unspent again */
+    rebuildKeyImageOwners();
 }
 
 void SubWallets::removeCancelledTransactions(
@@ -748,6 +971,8 @@ void SubWallets::removeCancelledTransactions(
 
     std::scoped_lock lock(m_mutex);
 
+    changedOutsideOfSync();
+
     /* Find any cancelled transactions */
     const auto it = std::remove_if(m_lockedTransactions.begin(), m_lockedTransactions.end(),
                                    [&cancelledTransactions](const auto &tx)
@@ -821,14 +1046,36 @@ void SubWallets::reset(const uint64_t scanHeight)
 {
     std::scoped_lock lock(m_mutex);
 
+    changedOutsideOfSync();
+
     m_lockedTransactions.clear();
-    m_transactions.clear();
+    rebuildTransactionHistory({});
     m_transactionPrivateKeys.clear();
 
     for (auto [pubKey, subWallet] : m_subWallets)
     {
         subWallet.reset(scanHeight);
     }
+
+    rebuildKeyImageOwners();
+}
+
+void SubWallets::rebuildKeyImageOwners()
+{
+    m_keyImageOwners.clear();
+
+    if (m_isViewWallet)
+    {
+        return;
+    }
+
+    for (const auto &[publicKey, subWallet] : m_subWallets)
+    {
+        for (const auto &keyImage : subWallet.getKeyImages())
+        {
+            m_keyImageOwners[keyImage] = publicKey;
+        }
+    }
 }
 
 std::vector<crypto::SecretKey> SubWallets::getPrivateSpendKeys() const
@@ -861,7 +1108,150 @@ crypto::SecretKey SubWallets::getPrimaryPrivateSpendKey() const
 
 std::vector<wallet_types::Transaction> SubWallets::getTransactions() const
 {
-    return m_transactions;
+    return getTransactionsRange(0, std::numeric_limits<uint64_t>::max());
+}
+
+std::vector<wallet_types::Transaction> SubWallets::getTransactionsRange(
+    const uint64_t startHeight,
+    const uint64_t endHeight) const
+{
+    const auto snapshot = getSnapshot(std::nullopt);
+
+    const auto &history = *snapshot->transactions;
+
+    std::shared_lock historyLock(history.mutex);
+
+    /* Fewer if a fork removed some since the snapshot was made */
+    const auto transactionsEnd = history.transactions.begin() + std::min(snapshot->transactionCount, history.transactions.size());
+
+    const auto byHeight = [](const wallet_types::Transaction &tx, const uint64_t height)
+    { return tx.blockHeight < height; };
+
+    const auto begin = std::lower_bound(history.transactions.begin(), transactionsEnd, startHeight, byHeight);
+    const auto end = std::lower_bound(begin, transactionsEnd, endHeight, byHeight);
+
+    return std::vector<wallet_types::Transaction>(begin, end);
+}
+
+std::tuple<Error, std::vector<wallet_types::Transaction>, std::optional<crypto::Hash>> SubWallets::getTransactionsPage(
+    const uint64_t startHeight,
+    const uint64_t endHeight,
+    const std::optional<crypto::PublicKey> publicSpendKey,
+    const std::optional<crypto::Hash> cursor,
+    const uint64_t limit) const
+{
+    const auto snapshot = getSnapshot(std::nullopt);
+
+    const auto &history = *snapshot->transactions;
+
+    std::shared_lock historyLock(history.mutex);
+
+    /* The transactions in the snapshot, fewer if a fork removed some since
+       it was made. The indexes may include transactions added since. */
+    const size_t transactionCount = std::min(snapshot->transactionCount, history.transactions.size());
+
+    /* Position in the history to start from */
+    size_t start = 0;
+
+    if (cursor)
+    {
+        const auto it = history.byHash.find(*cursor);
+
+        /* Probably removed by a fork since the last page was fetched */
+        if (it == history.byHash.end() || it->second >= transactionCount)
+        {
+            return {TRANSACTION_CURSOR_NOT_FOUND, {}, std::nullopt};
+        }
+
+        start = it->second + 1;
+    }
+
+    /* The positions of the transactions we're looking at, or nullptr if
+       we're looking at all of them */
+    const std::vector<size_t> *positions = nullptr;
+
+    if (publicSpendKey)
+    {
+        const auto it = history.byPublicSpendKey.find(*publicSpendKey);
+
+        if (it == history.byPublicSpendKey.end())
+        {
+            return {SUCCESS, {}, std::nullopt};
+        }
+
+        positions = &it->second;
+    }
+
+    const size_t count = positions
+        ? std::lower_bound(positions->begin(), positions->end(), transactionCount) - positions->begin()
+        : transactionCount;
+
+    const auto getTransaction = [&](const size_t i) -> const wallet_types::Transaction &
+    { return history.transactions[positions ? (*positions)[i] : i]; };
+
+    /* Find the first transaction after the cursor and at or above the start
+       height. Both are ordered by position, so binary search. */
+    size_t i = positions ? std::lower_bound(positions->begin(), positions->end(), start) - positions->begin() : start;
+
+    size_t first = i;
+    size_t last = count;
+
+    while (first < last)
+    {
+        const size_t mid = first + (last - first) / 2;
+
+        if (getTransaction(mid).blockHeight < startHeight)
+        {
+            first = mid + 1;
+        }
+        else
+        {
+            last = mid;
+        }
+    }
+
+    i = first;
+
+    std::vector<wallet_types::Transaction> result;
+
+    for (; i < count && result.size() < limit; i++)
+    {
+        const auto &tx = getTransaction(i);
+
+        if (tx.blockHeight >= endHeight)
+        {
+            break;
+        }
+
+        result.push_back(tx);
+    }
+
+    std::optional<crypto::Hash> nextCursor;
+
+    if (!result.empty() && i < count && getTransaction(i).blockHeight < endHeight)
+    {
+        nextCursor = result.back().hash;
+    }
+
+    return {SUCCESS, result, nextCursor};
+}
+
+std::optional<wallet_types::Transaction> SubWallets::getTransaction(const crypto::Hash &hash) const
+{
+    const auto snapshot = getSnapshot(std::nullopt);
+
+    const auto &history = *snapshot->transactions;
+
+    std::shared_lock historyLock(history.mutex);
+
+    const auto it = history.byHash.find(hash);
+
+    if (it != history.byHash.end() && it->second < std::min(snapshot->transactionCount, history.transactions.size()))
+    {
+        return history.transactions[it->second];
+    }
+
+    return std::nullopt;
 }
 
 /* Note that this DOES NOT return incoming transactions in the pool. It only
@@ -869,7 +1259,7 @@ std::vector<wallet_types::Transaction> SubWallets::getTransactions() const
    block yet. */
 std::vector<wallet_types::Transaction> SubWallets::getUnconfirmedTransactions() const
 {
-    return m_lockedTransactions;
+    return *getSnapshot(std::nullopt)->lockedTransactions;
 }
 
 std::tuple<Error, std::string> SubWallets::getAddress(
@@ -889,6 +1279,10 @@ void SubWallets::storeTxPrivateKey(
     const crypto::SecretKey txPrivateKey,
     const crypto::Hash txHash)
 {
+    std::scoped_lock lock(m_mutex);
+
+    changedOutsideOfSync();
+
     m_transactionPrivateKeys[txHash] = txPrivateKey;
 }
 
@@ -911,6 +1305,8 @@ void SubWallets::storeUnconfirmedIncomingInput(
 {
     std::scoped_lock lock(m_mutex);
 
+    changedOutsideOfSync();
+
     const auto it = m_subWallets.find(publicSpendKey);
 
     if (it != m_subWallets.end())
@@ -925,6 +1321,8 @@ void SubWallets::convertSyncTimestampToHeight(
 {
     std::scoped_lock lock(m_mutex);
 
+    changedOutsideOfSync();
+
     for (auto [pubKey, subWallet] : m_subWallets)
     {
         subWallet.convertSyncTimestampToHeight(timestamp, height);
@@ -934,16 +1332,7 @@ void SubWallets::convertSyncTimestampToHeight(
 std::vector<std::tuple<std::string, uint64_t, uint64_t>> SubWallets::getBalances(
     const uint64_t currentHeight) const
 {
-    std::vector<std::tuple<std::string, uint64_t, uint64_t>> balances;
-
-    for (auto [pubKey, subWallet] : m_subWallets)
-    {
-        const auto [unlocked, locked] = m_subWallets.at(pubKey).getBalance(currentHeight);
-
-        balances.emplace_back(subWallet.address(), unlocked, locked);
-    }
-
-    return balances;
+    return getSnapshot(currentHeight)->addressBalances;
 }
 
 void SubWallets::fromJSON(const JSONObject &j)
@@ -955,6 +1344,8 @@ void SubWallets::fromJSON(const JSONObject &j)
         m_publicSpendKeys.push_back(key);
     }
 
+    updatePublicSpendKeySet();
+
     for (const auto &x : getArrayFromJSON(j, "subWallet"))
     {
         SubWallet s;
@@ -962,18 +1353,22 @@ void SubWallets::fromJSON(const JSONObject &j)
         m_subWallets[s.publicSpendKey()] = s;
     }
 
+    std::vector<wallet_types::Transaction> transactions;
+
     for (const auto &x : getArrayFromJSON(j, "transactions"))
     {
         wallet_types::Transaction tx;
         tx.fromJSON(x);
-        m_transactions.push_back(tx);
+        transactions.push_back(tx);
     }
 
+    rebuildTransactionHistory(std::move(transactions));
+
     for (const auto &x : getArrayFromJSON(j, "lockedTransactions"))
     {
         wallet_types::Transaction tx;
         tx.fromJSON(x);
-        m_transactions.push_back(tx);
+        m_lockedTransactions.push_back(tx);
     }
 
     m_privateViewKey.fromString(getStringFromJSON(j, "privateViewKey"));
@@ -990,6 +1385,15 @@ void SubWallets::fromJSON(const JSONObject &j)
 
         m_transactionPrivateKeys[txHash] = privateKey;
     }
+
+    rebuildKeyImageOwners();
+
+    /* We were loaded from what's on disk, so can be journaled on top of it */
+    m_journal.clear();
+    m_journalInvalidated = false;
+
+    m_lockedTransactionsChanged = true;
+    m_snapshotStale = true;
 }
 
 void SubWallets::toJSON(rapidjson::Writer<rapidjson::StringBuffer> &writer) const
@@ -1014,9 +1418,13 @@ void SubWallets::toJSON(rapidjson::Writer<rapidjson::StringBuffer> &writer) cons
 
     writer.Key("transactions");
     writer.StartArray();
-    for (const auto &tx : m_transactions)
     {
-        tx.toJSON(writer);
+        std::shared_lock historyLock(m_transactionHistory->mutex);
+
+        for (const auto &tx : m_transactionHistory->transactions)
+        {
+            tx.toJSON(writer);
+        }
     }
     writer.EndArray();
 
@@ -1052,3 +1460,225 @@ void SubWallets::toJSON(rapidjson::Writer<rapidjson::StringBuffer> &writer) cons
 
     writer.EndObject();
 }
+
+bool SubWallets::takeJournal(rapidjson::Writer<rapidjson::StringBuffer> &writer)
+{
+    std::scoped_lock lock(m_mutex);
+
+    if (m_journalInvalidated)
+    {
+        return false;
+    }
+
+    writer.StartArray();
+    for (const auto &entry : m_journal)
+    {
+        writer.StartObject();
+
+        writer.Key("type");
+        writer.Uint(entry.type);
+
+        switch (entry.type)
+        {
+        case JournalEntry::ADD_TRANSACTION:
+        {
+            writer.Key("transaction");
+            entry.transaction.toJSON(writer);
+            break;
+        }
+        case JournalEntry::STORE_INPUT:
+        {
+            writer.Key("publicSpendKey");
+            entry.publicSpendKey.toJSON(writer);
+
+            writer.Key("input");
+            entry.input.toJSON(writer);
+            break;
+        }
+        case JournalEntry::SPEND_INPUT:
+        {
+            writer.Key("publicSpendKey");
+            entry.publicSpendKey.toJSON(writer);
+
+            writer.Key("keyImage");
+            entry.keyImage.toJSON(writer);
+
+            writer.Key("spendHeight");
+            writer.Uint64(entry.spendHeight);
+            break;
+        }
+        }
+
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    m_journal.clear();
+
+    return true;
+}
+
+void SubWallets::clearJournal()
+{
+    std::scoped_lock lock(m_mutex);
+
+    m_journal.clear();
+    m_journalInvalidated = false;
+}
+
+void SubWallets::applyJournal(const JSONValue &j)
+{
+    for (const auto &x : j.GetArray())
+    {
+        switch (getUint64FromJSON(x, "type"))
+        {
+        case JournalEntry::ADD_TRANSACTION:
+        {
+            wallet_types::Transaction tx;
+            tx.fromJSON(getJsonValue(x, "transaction"));
+            addTransaction(tx);
+            break;
+        }
+        case JournalEntry::STORE_INPUT:
+        {
+            crypto::PublicKey publicSpendKey;
+            publicSpendKey.fromString(getStringFromJSON(x, "publicSpendKey"));
+
+            wallet_types::TransactionInput input;
+            input.fromJSON(getJsonValue(x, "input"));
+
+            storeTransactionInput(publicSpendKey, input);
+            break;
+        }
+        case JournalEntry::SPEND_INPUT:
+        {
+            crypto::PublicKey publicSpendKey;
+            publicSpendKey.fromString(getStringFromJSON(x, "publicSpendKey"));
+
+            crypto::KeyImage keyImage;
+            keyImage.fromString(getStringFromJSON(x, "keyImage"));
+
+            markInputAsSpent(keyImage, publicSpendKey, getUint64FromJSON(x, "spendHeight"));
+            break;
+        }
+        default:
+        {
+            throw std::invalid_argument("Unknown wallet journal entry type");
+        }
+        }
+    }
+
+    /* What we just replayed is already in the journal on disk */
+    clearJournal();
+
+    m_snapshotStale = true;
+}
+
+void SubWallets::changedOutsideOfSync()
+{
+    m_journal.clear();
+    m_journalInvalidated = true;
+
+    m_lockedTransactionsChanged = true;
+    m_snapshotStale = true;
+}
+
+void SubWallets::publishSnapshot(const uint64_t height)
+{
+    std::scoped_lock lock(m_mutex);
+
+    std::atomic_store(&m_snapshot, makeSnapshot(height));
+
+    m_snapshotStale = false;
+}
+
+std::shared_ptr<const SubWallets::Snapshot> SubWallets::getSnapshot(
+    const std::optional<uint64_t> height) const
+{
+    auto snapshot = std::atomic_load(&m_snapshot);
+
+    if (snapshot && !m_snapshotStale && (!height || *height == snapshot->height))
+    {
+        return snapshot;
+    }
+
+    std::scoped_lock lock(m_mutex);
+
+    snapshot = makeSnapshot(height.value_or(snapshot ? snapshot->height : 0));
+
+    std::atomic_store(&m_snapshot, snapshot);
+
+    m_snapshotStale = false;
+
+    return snapshot;
+}
+
+std::shared_ptr<const SubWallets::Snapshot> SubWallets::makeSnapshot(const uint64_t height) const
+{
+    const auto previous = std::atomic_load(&m_snapshot);
+
+    auto snapshot = std::make_shared<Snapshot>();
+
+    snapshot->height = height;
+    snapshot->publicSpendKeys = m_publicSpendKeys;
+
+    for (const auto &[publicKey, subWallet] : m_subWallets)
+    {
+        const auto [unlocked, locked] = subWallet.getBalance(height);
+
+        snapshot->balances[publicKey] = {unlocked, locked};
+        snapshot->addressBalances.emplace_back(subWallet.address(), unlocked, locked);
+        snapshot->addresses.push_back(subWallet.address());
+
+        if (subWallet.isPrimaryAddress())
+        {
+            snapshot->primaryAddress = subWallet.address();
+        }
+    }
+
+    snapshot->transactions = m_transactionHistory;
+    snapshot->transactionCount = m_transactionHistory->transactions.size();
+
+    if (previous && !m_lockedTransactionsChanged)
+    {
+        snapshot->lockedTransactions = previous->lockedTransactions;
+    }
+    else
+    {
+        snapshot->lockedTransactions = std::make_shared<const std::vector<wallet_types::Transaction>>(m_lockedTransactions);
+
+        m_lockedTransactionsChanged = false;
+    }
+
+    return snapshot;
+}
+
+void SubWallets::rebuildTransactionHistory(std::vector<wallet_types::Transaction> transactions)
+{
+    auto history = std::make_shared<TransactionHistory>();
+
+    history->transactions = std::move(transactions);
+
+    /* Transactions are added in block order, but make sure, since the
+       range queries and removing forked transactions rely on it */
+    std::stable_sort(history->transactions.begin(), history->transactions.end(),
+                     [](const auto &a, const auto &b)
+                     { return a.blockHeight < b.blockHeight; });
+
+    history->byHash.reserve(history->transactions.size());
+
+    for (size_t i = 0; i < history->transactions.size(); i++)
+    {
+        const auto &tx = history->transactions[i];
+
+        history->byHash[tx.hash] = i;
+
+        for (const auto &[publicKey, amount] : tx.transfers)
+        {
+            history->byPublicSpendKey[publicKey].push_back(i);
+        }
+    }
+
+    /* Snapshots keep reading the old one */
+    m_transactionHistory = history;
+}
@@ -5,10 +5,20 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <crypto/crypto.h>
 
+#include <memory>
+
+#include <optional>
+
+#include <shared_mutex>
+
 #include <sub_wallets/sub_wallet.h>
 
+#include <unordered_set>
+
 class SubWallets
 {
 public:
@@ -65,6 +75,25 @@ public:
     /* Initializes the class from a json string */
     void fromJSON(const JSONObject &j);
 
+    /* Writes the transactions, inputs and spends stored since the journal
+       was last cleared as a JSON array, and clears the journal. If any other
+       change was made in that time, nothing is written and false is
+       returned - the whole wallet has to be saved instead. */
+    bool takeJournal(rapidjson::Writer<rapidjson::StringBuffer> &writer);
+
+    /* Called when the whole wallet has been saved */
+    void clearJournal();
+
+    /* Replays the changes written by takeJournal() */
+    void applyJournal(const JSONValue &j);
+
+    /* Publishes a copy of the balances at the given height, the addresses
+       and the transactions. The synchronizer calls this after applying each
+       batch of blocks, and API requests read from it without taking the
+       lock, so they don't wait on syncing. Any other change publishes a new
+       copy before it is next read. */
+    void publishSnapshot(const uint64_t height);
+
     /* Store a transaction */
     void addTransaction(const wallet_types::Transaction tx);
 
@@ -113,6 +142,11 @@ public:
     /* Gets the number of wallets in the container */
     uint64_t getWalletCount() const;
 
+    /* The public spend keys as a hash set, for checking if outputs are ours.
+       The set is never modified - adding or deleting a subwallet swaps in
+       a new one - so it can be used without holding any lock. */
+    std::shared_ptr<const std::unordered_set<crypto::PublicKey>> getPublicSpendKeySet() const;
+
     /* Get the sum of the balance of the subwallets pointed to. If
        takeFromAll, get the total balance from all subwallets. */
     std::tuple<uint64_t, uint64_t> getBalance(
@@ -159,6 +193,26 @@ public:
 
     std::vector<wallet_types::Transaction> getTransactions() const;
 
+    /* Returns transactions in the range [startHeight, endHeight - 1] */
+    std::vector<wallet_types::Transaction> getTransactionsRange(
+        const uint64_t startHeight,
+        const uint64_t endHeight) const;
+
+    /* Returns up to limit transactions in the range
+       [startHeight, endHeight - 1], oldest first. If a public spend key is
+       given, only transactions with a transfer to or from it are included.
+       If a cursor is given, starts after the transaction with that hash.
+       Also returns the cursor for the next page, if there is one. */
+    std::tuple<Error, std::vector<wallet_types::Transaction>, std::optional<crypto::Hash>> getTransactionsPage(
+        const uint64_t startHeight,
+        const uint64_t endHeight,
+        const std::optional<crypto::PublicKey> publicSpendKey,
+        const std::optional<crypto::Hash> cursor,
+        const uint64_t limit) const;
+
+    /* Gets the (confirmed) transaction with the given hash, if we have it */
+    std::optional<wallet_types::Transaction> getTransaction(const crypto::Hash &hash) const;
+
     /* Note that this DOES NOT return incoming transactions in the pool. It only
        returns outgoing transactions which we sent but have not encountered in a
        block yet. */
@@ -209,6 +263,107 @@ private:
         std::vector<wallet_types::Transaction> &txs,
         const crypto::PublicKey spendKey);
 
+    /* Recreates m_keyImageOwners from the subwallets, for when inputs are
+       removed in bulk */
+    void rebuildKeyImageOwners();
+
+    /* Replaces m_publicSpendKeySet, after m_publicSpendKeys changes */
+    void updatePublicSpendKeySet();
+
+    /* Replaces m_transactionHistory with one holding these transactions */
+    void rebuildTransactionHistory(std::vector<wallet_types::Transaction> transactions);
+
+    /* Called with m_mutex held by anything changing the wallet other than
+       addTransaction(), storeTransactionInput() and markInputAsSpent().
+       Invalidates the journal, and the published snapshot. */
+    void changedOutsideOfSync();
+
+    /* The confirmed transactions, ordered by block height, with indexes to
+       find them without a linear scan. Synced transactions are appended, and
+       a fork drops them from the end, so snapshots share this with us and
+       only read the transactions there were when they were made. Anything
+       else changing the transactions replaces it, see
+       rebuildTransactionHistory(). */
+    struct TransactionHistory
+    {
+        /* Held exclusively by us whilst appending or removing a transaction,
+           and shared by snapshot readers */
+        mutable std::shared_mutex mutex;
+
+        std::vector<wallet_types::Transaction> transactions;
+
+        /* Position of each transaction */
+        std::unordered_map<crypto::Hash, size_t> byHash;
+
+        /* Positions of the transactions with a transfer to or from each
+           public spend key, in order */
+        std::unordered_map<crypto::PublicKey, std::vector<size_t>> byPublicSpendKey;
+    };
+
+    /* What the getters used by API requests read from, see
+       publishSnapshot() */
+    struct Snapshot
+    {
+        /* The height the balances were worked out at */
+        uint64_t height = 0;
+
+        std::unordered_map<crypto::PublicKey, std::tuple<uint64_t, uint64_t>> balances;
+
+        /* Address, unlocked balance, locked balance */
+        std::vector<std::tuple<std::string, uint64_t, uint64_t>> addressBalances;
+
+        std::vector<crypto::PublicKey> publicSpendKeys;
+
+        std::vector<std::string> addresses;
+
+        /* Empty if there isn't one */
+        std::string primaryAddress;
+
+        /* Shared with us, only the first transactionCount are in the
+           snapshot. Take the history's mutex to read them. */
+        std::shared_ptr<const TransactionHistory> transactions;
+
+        size_t transactionCount = 0;
+
+        /* Shared with the previous snapshot if they haven't changed */
+        std::shared_ptr<const std::vector<wallet_types::Transaction>> lockedTransactions;
+    };
+
+    /* Gets the published snapshot, first publishing a new one if the wallet
+       has been changed by anything but syncing since, or if the balances
+       are needed at a different height */
+    std::shared_ptr<const Snapshot> getSnapshot(const std::optional<uint64_t> height) const;
+
+    /* Makes a snapshot from the current state. Called with m_mutex held. */
+    std::shared_ptr<const Snapshot> makeSnapshot(const uint64_t height) const;
+
+    /* A change made while syncing, see takeJournal() */
+    struct JournalEntry
+    {
+        enum Type
+        {
+            ADD_TRANSACTION,
+            STORE_INPUT,
+            SPEND_INPUT
+        };
+
+        Type type;
+
+        /* ADD_TRANSACTION */
+        wallet_types::Transaction transaction;
+
+        /* STORE_INPUT and SPEND_INPUT */
+        crypto::PublicKey publicSpendKey;
+
+        /* STORE_INPUT */
+        wallet_types::TransactionInput input;
+
+        /* SPEND_INPUT */
+        crypto::KeyImage keyImage;
+
+        uint64_t spendHeight = 0;
+    };
+
     //////////////////////////////
     /* Private member variables */
     //////////////////////////////
@@ -216,8 +371,8 @@ private:
     /* The subwallets, indexed by public spend key */
     std::unordered_map<crypto::PublicKey, SubWallet> m_subWallets;
 
-    /* A vector of transactions */
-    std::vector<wallet_types::Transaction> m_transactions;
+    /* The transactions in blocks */
+    std::shared_ptr<TransactionHistory> m_transactionHistory = std::make_shared<TransactionHistory>();
 
     /* Transactions which we sent, but haven't been added to a block yet */
     std::vector<wallet_types::Transaction> m_lockedTransactions;
@@ -229,6 +384,34 @@ private:
     /* Transaction private keys of sent transactions, used for auditing */
     std::unordered_map<crypto::Hash, crypto::SecretKey> m_transactionPrivateKeys;
 
+    /* The public spend key of the subwallet owning each key image we can
+       spend (unspent and locked inputs). getKeyImageOwner() is called for
+       every input of every transaction we sync, so this saves searching
+       every input of every subwallet. Not used for view wallets, which
+       don't have key images. */
+    std::unordered_map<crypto::KeyImage, crypto::PublicKey> m_keyImageOwners;
+
+    /* Changes made while syncing which haven't been saved yet */
+    std::vector<JournalEntry> m_journal;
+
+    /* A change which can't be journaled was made since the wallet was last
+       saved in full. New and copied wallets have never been saved. */
+    bool m_journalInvalidated = true;
+
+    /* The contents of m_publicSpendKeys, see getPublicSpendKeySet() */
+    std::shared_ptr<const std::unordered_set<crypto::PublicKey>> m_publicSpendKeySet = std::make_shared<const std::unordered_set<crypto::PublicKey>>();
+
+    /* See publishSnapshot(). Read and replaced with std::atomic_load and
+       std::atomic_store, so readers never wait. */
+    mutable std::shared_ptr<const Snapshot> m_snapshot;
+
+    /* The wallet was changed by something other than syncing since the
+       snapshot was published */
+    mutable std::atomic<bool> m_snapshotStale = true;
+
+    /* The locked transactions changed since the snapshot was published */
+    mutable bool m_lockedTransactionsChanged = true;
+
     /* Need a mutex for accessing inputs, transactions, and locked
        transactions, etc as these are modified on multiple threads */
     mutable std::mutex m_mutex;
@@ -0,0 +1,354 @@
+// Copyright (c) 2019, The Kryptokrona Developers
+//
+// Please see the included LICENSE file for more information.
+
+/* Checks that the running balance totals SubWallet keeps give the same
+   result as summing every unspent input with utilities::isInputUnlocked(),
+   over a long random run of stored, spent, locked, cancelled and forked
+   inputs, with the wallet saved and reloaded now and then. */
+
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <config/mevacoin_config.h>
+
+#include <sub_wallets/sub_wallet.h>
+
+#include <utilities/utilities.h>
+
+#define OPERATIONS 20000
+
+/* Heights to check the balance at after each operation, around the current
+   one, so the unlocked sum gets moved back as well as forwards */
+#define HEIGHTS_CHECKED 4
+
+/* Only used for the amounts and which operation to do next, so a fixed seed
+   keeps any failure reproducible */
+std::mt19937_64 generator(1);
+
+uint64_t randomValue(const uint64_t min, const uint64_t max)
+{
+    return std::uniform_int_distribution<uint64_t>(min, max)(generator);
+}
+
+template <typename T>
+T randomPod()
+{
+    T value;
+
+    for (auto &byte : value.data)
+    {
+        byte = static_cast<uint8_t>(randomValue(0, 255));
+    }
+
+    return value;
+}
+
+[[noreturn]] void failCheck(const std::string &message)
+{
+    std::cout << "Error: " << message << std::endl;
+    exit(1);
+}
+
+/* What the wallet should hold. The unspent inputs are read back from the
+   SubWallet itself, but the unconfirmed incoming amounts aren't exposed,
+   so they are tracked here */
+struct Model
+{
+    /* The unconfirmed incoming amounts, by the key of the output */
+    std::vector<wallet_types::UnconfirmedInput> unconfirmedInputs;
+
+    /* Key images of the inputs locked in an outgoing transaction */
+    std::vector<crypto::KeyImage> lockedKeyImages;
+
+    /* Parent transaction hashes of the locked inputs, by key image */
+    std::unordered_map<crypto::KeyImage, crypto::Hash> lockedTransactions;
+
+    uint64_t height = 0;
+};
+
+wallet_types::TransactionInput makeInput(const uint64_t height)
+{
+    wallet_types::TransactionInput input;
+
+    input.keyImage = randomPod<crypto::KeyImage>();
+
+    /* Spread over many digits, to exercise the fusion buckets too */
+    input.amount = randomValue(1, 9) * static_cast<uint64_t>(std::pow(10, randomValue(0, 12)));
+
+    input.blockHeight = height;
+    input.transactionPublicKey = randomPod<crypto::PublicKey>();
+    input.transactionIndex = randomValue(0, 10);
+    input.globalOutputIndex = randomValue(0, 1000000);
+    input.key = randomPod<crypto::PublicKey>();
+    input.spendHeight = 0;
+    input.parentTransactionHash = randomPod<crypto::Hash>();
+
+    const uint64_t kind = randomValue(0, 9);
+
+    if (kind < 5)
+    {
+        input.unlockTime = 0;
+    }
+    else if (kind < 7)
+    {
+        /* A coinbase output */
+        input.unlockTime = height + mevacoin::parameters::MEVACOIN_MINED_MONEY_UNLOCK_WINDOW;
+    }
+    else if (kind < 9)
+    {
+        /* A custom unlock height, possibly already passed */
+        input.unlockTime = randomValue(height > 50 ? height - 50 : 1, height + 50);
+    }
+    else
+    {
+        /* A timestamp, far enough from now that it can't pass between working
+           out the expected balance and asking the wallet for it */
+        const uint64_t now = static_cast<uint64_t>(std::time(nullptr));
+
+        input.unlockTime = randomValue(0, 1) ? now - 24 * 60 * 60 : now + 24 * 60 * 60;
+    }
+
+    return input;
+}
+
+void checkBalance(const SubWallet &subWallet, const Model &model, const uint64_t operation, const std::string &description)
+{
+    for (int i = 0; i < HEIGHTS_CHECKED; i++)
+    {
+        const uint64_t height = i == 0 ? model.height : randomValue(model.height > 30 ? model.height - 30 : 0, model.height + 30);
+
+        /* The full scan getBalance() used to do */
+        uint64_t expectedUnlocked = 0;
+        uint64_t expectedLocked = 0;
+
+        std::unordered_map<int, uint64_t> expectedBuckets;
+
+        for (const auto &input : subWallet.unspentInputs())
+        {
+            if (utilities::isInputUnlocked(input.unlockTime, height))
+            {
+                expectedUnlocked += input.amount;
+            }
+            else
+            {
+                expectedLocked += input.amount;
+            }
+
+            expectedBuckets[SubWallet::fusionBucket(input.amount)]++;
+        }
+
+        for (const auto &input : model.unconfirmedInputs)
+        {
+            expectedLocked += input.amount;
+        }
+
+        const auto [unlocked, locked] = subWallet.getBalance(height);
+
+        if (unlocked != expectedUnlocked || locked != expectedLocked)
+        {
+            failCheck(
+                "balance differs from the full scan after operation " + std::to_string(operation)
+                + " (" + description + "), at height " + std::to_string(height)
+                + ": unlocked " + std::to_string(unlocked) + ", expected " + std::to_string(expectedUnlocked)
+                + ", locked " + std::to_string(locked) + ", expected " + std::to_string(expectedLocked));
+        }
+
+        if (subWallet.fusionBucketSizes() != expectedBuckets)
+        {
+            failCheck(
+                "fusion bucket sizes differ from the full scan after operation " + std::to_string(operation)
+                + " (" + description + ")");
+        }
+    }
+}
+
+/* Saves the subwallet and loads it into a new one, which rebuilds the totals */
+SubWallet reload(const SubWallet &subWallet)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+    subWallet.toJSON(writer);
+
+    rapidjson::Document document;
+
+    if (document.Parse(buffer.GetString()).HasParseError())
+    {
+        failCheck("could not parse the saved subwallet");
+    }
+
+    SubWallet loaded;
+    loaded.fromJSON(document);
+
+    return loaded;
+}
+
+int main()
+{
+    crypto::PublicKey publicSpendKey;
+    crypto::SecretKey privateSpendKey;
+
+    crypto::generate_keys(publicSpendKey, privateSpendKey);
+
+    SubWallet subWallet(publicSpendKey, privateSpendKey, "address", 0, 0, true);
+
+    Model model;
+
+    for (uint64_t operation = 0; operation < OPERATIONS; operation++)
+    {
+        const auto &unspent = subWallet.unspentInputs();
+
+        /* An operation that can't be done right now, like spending with no
+           unspent inputs, falls through to the next one that can */
+        const uint64_t choice = randomValue(0, 99);
+
+        std::string description;
+
+        if (choice < 35)
+        {
+            description = "store an input";
+
+            auto input = makeInput(model.height);
+
+            /* Sometimes the change from a transaction we sent coming in */
+            if (!model.unconfirmedInputs.empty() && randomValue(0, 3) == 0)
+            {
+                const size_t index = randomValue(0, model.unconfirmedInputs.size() - 1);
+
+                input.key = model.unconfirmedInputs[index].key;
+                model.unconfirmedInputs.erase(model.unconfirmedInputs.begin() + index);
+            }
+
+            subWallet.storeTransactionInput(input, false);
+        }
+        else if (choice < 45)
+        {
+            description = "store an unconfirmed incoming amount";
+
+            wallet_types::UnconfirmedInput input;
+            input.amount = randomValue(1, 1000000000);
+            input.key = randomPod<crypto::PublicKey>();
+            input.parentTransactionHash = randomPod<crypto::Hash>();
+
+            subWallet.storeUnconfirmedIncomingInput(input);
+            model.unconfirmedInputs.push_back(input);
+        }
+        else if (choice < 60)
+        {
+            description = "advance the height";
+
+            model.height += randomValue(1, 5);
+        }
+        else if (choice < 70 && !unspent.empty())
+        {
+            description = "spend an input";
+
+            subWallet.markInputAsSpent(unspent[randomValue(0, unspent.size() - 1)].keyImage, model.height);
+        }
+        else if (choice < 78 && !unspent.empty())
+        {
+            description = "lock an input";
+
+            const auto input = unspent[randomValue(0, unspent.size() - 1)];
+
+            subWallet.markInputAsLocked(input.keyImage);
+
+            model.lockedKeyImages.push_back(input.keyImage);
+            model.lockedTransactions[input.keyImage] = input.parentTransactionHash;
+        }
+        else if (choice < 83 && !model.lockedKeyImages.empty())
+        {
+            description = "spend a locked input";
+
+            const size_t index = randomValue(0, model.lockedKeyImages.size() - 1);
+
+            subWallet.markInputAsSpent(model.lockedKeyImages[index], model.height);
+
+            model.lockedTransactions.erase(model.lockedKeyImages[index]);
+            model.lockedKeyImages.erase(model.lockedKeyImages.begin() + index);
+        }
+        else if (choice < 88 && (!model.lockedKeyImages.empty() || !model.unconfirmedInputs.empty()))
+        {
+            description = "cancel a transaction";
+
+            std::unordered_set<crypto::Hash> cancelled;
+
+            if (!model.lockedKeyImages.empty())
+            {
+                cancelled.insert(model.lockedTransactions[model.lockedKeyImages[randomValue(0, model.lockedKeyImages.size() - 1)]]);
+            }
+
+            if (!model.unconfirmedInputs.empty())
+            {
+                cancelled.insert(model.unconfirmedInputs[randomValue(0, model.unconfirmedInputs.size() - 1)].parentTransactionHash);
+            }
+
+            subWallet.removeCancelledTransactions(cancelled);
+
+            for (auto it = model.lockedKeyImages.begin(); it != model.lockedKeyImages.end();)
+            {
+                if (cancelled.find(model.lockedTransactions[*it]) != cancelled.end())
+                {
+                    model.lockedTransactions.erase(*it);
+                    it = model.lockedKeyImages.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            for (auto it = model.unconfirmedInputs.begin(); it != model.unconfirmedInputs.end();)
+            {
+                it = cancelled.find(it->parentTransactionHash) != cancelled.end() ? model.unconfirmedInputs.erase(it) : it + 1;
+            }
+        }
+        else if (choice < 93)
+        {
+            description = "fork";
+
+            const uint64_t forkHeight = randomValue(model.height > 20 ? model.height - 20 : 0, model.height);
+
+            subWallet.removeForkedInputs(forkHeight);
+
+            /* Locked inputs and unconfirmed amounts are dropped, to be found
+               again by the wallet */
+            model.lockedKeyImages.clear();
+            model.lockedTransactions.clear();
+            model.unconfirmedInputs.clear();
+
+            model.height = forkHeight;
+        }
+        else if (choice < 99)
+        {
+            description = "save and reload";
+
+            subWallet = reload(subWallet);
+        }
+        else
+        {
+            description = "reset";
+
+            model.height = randomValue(0, model.height);
+
+            subWallet.reset(model.height);
+
+            model.lockedKeyImages.clear();
+            model.lockedTransactions.clear();
+            model.unconfirmedInputs.clear();
+        }
+
+        checkBalance(subWallet, model, operation, description);
+    }
+
+    std::cout << "SubWallet balance: matches the full scan over " << OPERATIONS << " operations" << std::endl;
+
+    return 0;
+}
@@ -12,7 +12,6 @@
 #include <future>
 
 #include "common_types.h"
-#include "common/blocking_queue.h"
 #include "mevacoin_core/mevacoin_basic_impl.h"
 #include "mevacoin_core/mevacoin_format_utils.h"
 #include "mevacoin_core/transaction_api.h"
@@ -242,83 +241,78 @@ namespace mevacoin
         {
         };
 
+        // in block order, each worker fills in the slots it takes
         std::vector<PreprocessedTx> preprocessedTransactions;
-        std::mutex preprocessedTransactionsMutex;
 
-        size_t workers = std::thread::hardware_concurrency();
-        if (workers == 0)
+        size_t emptyBlockCount = 0;
+
+        for (uint32_t i = 0; i < count; ++i)
         {
-            workers = 2;
-        }
+            const auto &block = blocks[i].block;
 
-        BlockingQueue<Tx> inputQueue(workers * 2);
+            if (!block.is_initialized())
+            {
+                ++emptyBlockCount;
+                continue;
+            }
 
-        std::atomic<bool> stopProcessing(false);
-        std::atomic<size_t> emptyBlockCount(0);
-
-        auto pushingThread = std::async(std::launch::async, [&]
-                                        {
-    for( uint32_t i = 0; i < count && !stopProcessing; ++i) {
-      const auto& block = blocks[i].block;
-
-      if (!block.is_initialized()) {
-        ++emptyBlockCount;
-        continue;
-      }
-
-      // filter by syncStartTimestamp
-      if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp) {
-        ++emptyBlockCount;
-        continue;
-      }
-
-      TransactionBlockInfo blockInfo;
-      blockInfo.height = startHeight + i;
-      blockInfo.timestamp = block->timestamp;
-      blockInfo.transactionIndex = 0; // position in block
-
-      for (const auto& tx : blocks[i].transactions) {
-        auto pubKey = tx->getTransactionPublicKey();
-        if (pubKey == NULL_PUBLIC_KEY) {
-          ++blockInfo.transactionIndex;
-          continue;
-        }
-
-        bool isLastTransactionInBlock = blockInfo.transactionIndex + 1 == blocks[i].transactions.size();
-        Tx item = { blockInfo, tx.get(), isLastTransactionInBlock };
-        inputQueue.push(item);
-        ++blockInfo.transactionIndex;
-      }
-    }
+            // filter by syncStartTimestamp
+            if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp)
+            {
+                ++emptyBlockCount;
+                continue;
+            }
 
-    inputQueue.close(); });
+            TransactionBlockInfo blockInfo;
+            blockInfo.height = startHeight + i;
+            blockInfo.timestamp = block->timestamp;
+            blockInfo.transactionIndex = 0; // position in block
+
+            for (const auto &tx : blocks[i].transactions)
+            {
+                auto pubKey = tx->getTransactionPublicKey();
+                if (pubKey == NULL_PUBLIC_KEY)
+                {
+                    ++blockInfo.transactionIndex;
+                    continue;
+                }
+
+                PreprocessedTx item;
+                item.blockInfo = blockInfo;
+                item.tx = tx.get();
+                item.isLastTransactionInBlock = blockInfo.transactionIndex + 1 == blocks[i].transactions.size();
+                preprocessedTransactions.push_back(std::move(item));
+                ++blockInfo.transactionIndex;
+            }
+        }
+
+        std::atomic<bool> stopProcessing(false);
+        std::atomic<size_t> nextTransaction(0);
 
         auto processingFunction = [&]
         {
-            Tx item;
             std::error_code ec;
-            while (!stopProcessing && inputQueue.pop(item))
+            size_t i;
+            while (!stopProcessing && (i = nextTransaction++) < preprocessedTransactions.size())
             {
-                PreprocessedTx output;
-                static_cast<Tx &>(output) = item;
+                auto &item = preprocessedTransactions[i];
 
-                ec = preprocessOutputs(item.blockInfo, *item.tx, output);
+                ec = preprocessOutputs(item.blockInfo, *item.tx, item);
                 if (ec)
                 {
                     stopProcessing = true;
                     break;
                 }
-
-                std::lock_guard<std::mutex> lk(preprocessedTransactionsMutex);
-                preprocessedTransactions.push_back(std::move(output));
             }
             return ec;
         };
 
+        const size_t workers = std::min(m_preprocessingPool.threadCount(), preprocessedTransactions.size());
+
         std::vector<std::future<std::error_code>> processingThreads;
         for (size_t i = 0; i < workers; ++i)
         {
-            processingThreads.push_back(std::async(std::launch::async, processingFunction));
+            processingThreads.push_back(m_preprocessingPool.addJob(processingFunction));
         }
 
         std::error_code processingError;
@@ -353,10 +347,6 @@ namespace mevacoin
         std::vector<crypto::Hash> blockHashes = getBlockHashes(blocks, count);
         m_observerManager.notify(&IBlockchainConsumerObserver::onBlocksAdded, this, blockHashes);
 
-        // sort by block height and transaction index in block
-        std::sort(preprocessedTransactions.begin(), preprocessedTransactions.end(), [](const PreprocessedTx &a, const PreprocessedTx &b)
-                  { return std::tie(a.blockInfo.height, a.blockInfo.transactionIndex) < std::tie(b.blockInfo.height, b.blockInfo.transactionIndex); });
-
         uint32_t processedBlockCount = static_cast<uint32_t>(emptyBlockCount);
         try
         {
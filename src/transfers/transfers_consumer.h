@@ -13,6 +13,7 @@
 #include "transfers_subscription.h"
 #include "type_helpers.h"
 
+#include "common/thread_pool.h"
 #include "crypto/crypto.h"
 #include "logging/logger_ref.h"
 
@@ -85,6 +86,10 @@ namespace mevacoin
         INode &m_node;
         const mevacoin::Currency &m_currency;
         logging::LoggerRef m_logger;
+
+        // finds our outputs in new blocks, kept for the lifetime of the consumer
+        // so we don't start new threads for every batch
+        common::ThreadPool m_preprocessingPool;
     };
 
 }
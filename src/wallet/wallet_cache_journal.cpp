@@ -0,0 +1,508 @@
+// Copyright (c) 2019, The Kryptokrona Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "wallet_cache_journal.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+
+#include "common/memory_input_stream.h"
+#include "common/string_output_stream.h"
+#include "crypto/random.h"
+#include "mevacoin_core/mevacoin_serialization.h"
+#include "serialization/binary_input_stream_serializer.h"
+#include "serialization/binary_output_stream_serializer.h"
+
+extern "C"
+{
+#include "crypto/blake256.h"
+}
+
+namespace mevacoin
+{
+
+    namespace
+    {
+
+        const uint8_t CHUNK_RECORD = 1;
+        const uint8_t MANIFEST_RECORD = 2;
+
+        /* A chunk ends where the top 13 bits of the rolling hash are clear,
+           giving chunks of about 8KB. The cut points depend on the bytes just
+           before them rather than on offsets, so when data is inserted or
+           removed only the chunks around it change. */
+        const uint64_t CHUNK_BOUNDARY_MASK = UINT64_C(0x1fff) << 51;
+        const size_t MIN_CHUNK_SIZE = 2 * 1024;
+        const size_t MAX_CHUNK_SIZE = 64 * 1024;
+
+        /* Write a full snapshot once the appended section would be more than
+           half the size of the cache */
+        const uint64_t COMPACTION_DIVISOR = 2;
+
+        std::array<uint64_t, 256> makeGearTable()
+        {
+            std::array<uint64_t, 256> table;
+
+            /* splitmix64, so the table is the same everywhere */
+            uint64_t state = 0;
+
+            for (auto &value : table)
+            {
+                state += UINT64_C(0x9e3779b97f4a7c15);
+
+                uint64_t z = state;
+                z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+                z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+
+                value = z ^ (z >> 31);
+            }
+
+            return table;
+        }
+
+        const std::array<uint64_t, 256> gearTable = makeGearTable();
+
+        /* Returns the offset just past the end of each chunk */
+        std::vector<size_t> findChunkEnds(const uint8_t *data, size_t size)
+        {
+            std::vector<size_t> chunkEnds;
+
+            size_t start = 0;
+
+            while (start < size)
+            {
+                const size_t maxEnd = std::min(start + MAX_CHUNK_SIZE, size);
+
+                size_t end = maxEnd;
+                uint64_t hash = 0;
+
+                /* Each byte is shifted out of the hash 64 bytes later, so
+                   there's no need to hash the start of the chunk, which is
+                   too short to be cut anyway */
+                for (size_t i = std::min(start + MIN_CHUNK_SIZE - 64, maxEnd); i < maxEnd; i++)
+                {
+                    hash = (hash << 1) + gearTable[data[i]];
+
+                    if (i + 1 - start >= MIN_CHUNK_SIZE && (hash & CHUNK_BOUNDARY_MASK) == 0)
+                    {
+                        end = i + 1;
+                        break;
+                    }
+                }
+
+                chunkEnds.push_back(end);
+                start = end;
+            }
+
+            return chunkEnds;
+        }
+
+        uint64_t rotl(uint64_t x, int r)
+        {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        uint64_t fmix(uint64_t k)
+        {
+            k ^= k >> 33;
+            k *= UINT64_C(0xff51afd7ed558ccd);
+            k ^= k >> 33;
+            k *= UINT64_C(0xc4ceb9fe1a85ec53);
+            k ^= k >> 33;
+
+            return k;
+        }
+
+        struct RecordChecksum
+        {
+            uint64_t low;
+            uint64_t high;
+
+            bool operator!=(const RecordChecksum &other) const
+            {
+                return low != other.low || high != other.high;
+            }
+        };
+
+        /* MurmurHash3 x64 128. Not a cryptographic hash, so only used for the
+           record checksums, which just have to catch torn writes */
+        RecordChecksum murmurHash(const uint8_t *data, size_t size)
+        {
+            const uint64_t c1 = UINT64_C(0x87c37b91114253d5);
+            const uint64_t c2 = UINT64_C(0x4cf5ad432745937f);
+
+            uint64_t h1 = 0;
+            uint64_t h2 = 0;
+
+            const size_t blocks = size / 16;
+
+            for (size_t i = 0; i < blocks; i++)
+            {
+                uint64_t k1;
+                uint64_t k2;
+
+                std::memcpy(&k1, data + i * 16, sizeof(k1));
+                std::memcpy(&k2, data + i * 16 + 8, sizeof(k2));
+
+                k1 *= c1;
+                k1 = rotl(k1, 31);
+                k1 *= c2;
+                h1 ^= k1;
+
+                h1 = rotl(h1, 27);
+                h1 += h2;
+                h1 = h1 * 5 + 0x52dce729;
+
+                k2 *= c2;
+                k2 = rotl(k2, 33);
+                k2 *= c1;
+                h2 ^= k2;
+
+                h2 = rotl(h2, 31);
+                h2 += h1;
+                h2 = h2 * 5 + 0x38495ab5;
+            }
+
+            const uint8_t *tail = data + blocks * 16;
+
+            uint64_t k1 = 0;
+            uint64_t k2 = 0;
+
+            for (size_t i = size & 15; i > 8; i--)
+            {
+                k2 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 9) * 8);
+            }
+
+            for (size_t i = std::min<size_t>(size & 15, 8); i > 0; i--)
+            {
+                k1 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 1) * 8);
+            }
+
+            if ((size & 15) > 8)
+            {
+                k2 *= c2;
+                k2 = rotl(k2, 33);
+                k2 *= c1;
+                h2 ^= k2;
+            }
+
+            if ((size & 15) != 0)
+            {
+                k1 *= c1;
+                k1 = rotl(k1, 31);
+                k1 *= c2;
+                h1 ^= k1;
+            }
+
+            h1 ^= size;
+            h2 ^= size;
+
+            h1 += h2;
+            h2 += h1;
+
+            h1 = fmix(h1);
+            h2 = fmix(h2);
+
+            h1 += h2;
+            h2 += h1;
+
+            return {h1, h2};
+        }
+
+        /* Only there to catch records cut off or left half written */
+        RecordChecksum recordChecksum(const crypto::chacha8_iv &iv, const BinaryArray &encrypted)
+        {
+            const auto hash = murmurHash(encrypted.data(), encrypted.size());
+
+            uint64_t ivValue;
+            std::memcpy(&ivValue, &iv, sizeof(ivValue));
+
+            return {hash.low ^ fmix(ivValue), hash.high};
+        }
+
+        void writeRecord(std::string &records, uint8_t type, const void *data, size_t size, const crypto::chacha8_key &key, crypto::chacha8_iv iv)
+        {
+            BinaryArray encrypted(size);
+            crypto::chacha8(data, size, key, iv, reinterpret_cast<char *>(encrypted.data()));
+
+            auto checksum = recordChecksum(iv, encrypted);
+
+            common::StringOutputStream stream(records);
+            BinaryOutputStreamSerializer serializer(stream);
+            serializer(type, "type");
+            serializer(iv, "iv");
+            serializer(encrypted, "data");
+            serializer.binary(&checksum, sizeof(checksum), "checksum");
+        }
+
+        /* Chunks are deduplicated by their id alone, so two chunks sharing one
+           would corrupt the cache. BLAKE-256 is a cryptographic hash, so that
+           can't be arranged, and is about twice as fast as Keccak. The key
+           keeps the ids of the wallet's data from being worked out ahead. */
+        crypto::Hash chunkId(const std::array<uint8_t, 32> &key, const uint8_t *data, size_t size)
+        {
+            /* blake256_update() takes the length in bits */
+            state hashState;
+            blake256_init(&hashState);
+            blake256_update(&hashState, key.data(), key.size() * 8);
+            blake256_update(&hashState, data, size * 8);
+
+            crypto::Hash hash;
+            blake256_final(&hashState, hash.data);
+
+            return hash;
+        }
+
+    }
+
+    WalletCacheJournal::WalletCacheJournal() : m_valid(false),
+                                               m_chunkCount(0),
+                                               m_appendedSize(0),
+                                               m_chunkIdKey()
+    {
+    }
+
+    void WalletCacheJournal::clear()
+    {
+        /* Chunk ids are only kept in memory, so the key can change each time */
+        rnd::randomBytes(m_chunkIdKey.size(), m_chunkIdKey.data());
+
+        m_valid = false;
+        m_chunkIds.clear();
+        m_chunkCount = 0;
+        m_manifest.clear();
+        m_appendedSize = 0;
+    }
+
+    void WalletCacheJournal::reset(const void *containerData, size_t containerDataSize)
+    {
+        clear();
+
+        const auto *data = static_cast<const uint8_t *>(containerData);
+
+        size_t start = 0;
+
+        for (const size_t end : findChunkEnds(data, containerDataSize))
+        {
+            m_chunkIds.emplace(chunkId(m_chunkIdKey, data + start, end - start), m_chunkCount);
+            m_manifest.push_back(m_chunkCount++);
+            start = end;
+        }
+
+        m_valid = true;
+    }
+
+    void WalletCacheJournal::load(const uint8_t *records, size_t recordsSize, const crypto::chacha8_key &key, BinaryArray &containerData)
+    {
+        clear();
+
+        /* Where the data of each chunk is, by id. The snapshot chunks point
+           into containerData, the appended ones into appendedChunks */
+        std::vector<std::pair<const uint8_t *, size_t>> chunks;
+        std::deque<BinaryArray> appendedChunks;
+
+        size_t start = 0;
+
+        for (const size_t end : findChunkEnds(containerData.data(), containerData.size()))
+        {
+            m_chunkIds.emplace(chunkId(m_chunkIdKey, containerData.data() + start, end - start), m_chunkCount);
+            m_manifest.push_back(m_chunkCount++);
+
+            chunks.emplace_back(containerData.data() + start, end - start);
+            start = end;
+        }
+
+        if (recordsSize == 0)
+        {
+            m_valid = true;
+            return;
+        }
+
+        common::MemoryInputStream stream(records, recordsSize);
+        uint64_t validSize = 0;
+
+        while (!stream.endOfStream())
+        {
+            uint8_t type;
+            crypto::chacha8_iv iv;
+            BinaryArray encrypted;
+            RecordChecksum checksum;
+
+            try
+            {
+                BinaryInputStreamSerializer serializer(stream);
+                serializer(type, "type");
+                serializer(iv, "iv");
+                serializer(encrypted, "data");
+                serializer.binary(&checksum, sizeof(checksum), "checksum");
+            }
+            catch (const std::exception &)
+            {
+                break;
+            }
+
+            /* Left over from an interrupted save */
+            if ((type != CHUNK_RECORD && type != MANIFEST_RECORD) || checksum != recordChecksum(iv, encrypted))
+            {
+                break;
+            }
+
+            BinaryArray data(encrypted.size());
+            crypto::chacha8(encrypted.data(), encrypted.size(), key, iv, reinterpret_cast<char *>(data.data()));
+
+            if (type == CHUNK_RECORD)
+            {
+                m_chunkIds.emplace(chunkId(m_chunkIdKey, data.data(), data.size()), m_chunkCount++);
+
+                appendedChunks.push_back(std::move(data));
+                chunks.emplace_back(appendedChunks.back().data(), appendedChunks.back().size());
+            }
+            else
+            {
+                common::MemoryInputStream manifestStream(data.data(), data.size());
+                BinaryInputStreamSerializer serializer(manifestStream);
+
+                uint64_t count;
+                serializer(count, "count");
+
+                std::vector<uint64_t> manifest(count);
+
+                for (auto &id : manifest)
+                {
+                    serializer(id, "id");
+
+                    if (id >= chunks.size())
+                    {
+                        throw std::runtime_error("Wallet cache manifest refers to a missing chunk");
+                    }
+                }
+
+                m_manifest = std::move(manifest);
+            }
+
+            validSize = stream.getPosition();
+        }
+
+        m_appendedSize = validSize;
+
+        /* Anything appended after the garbage would never be read back */
+        m_valid = validSize == recordsSize;
+
+        size_t totalSize = 0;
+
+        for (const uint64_t id : m_manifest)
+        {
+            totalSize += chunks[id].second;
+        }
+
+        BinaryArray cacheData;
+        cacheData.reserve(totalSize);
+
+        for (const uint64_t id : m_manifest)
+        {
+            cacheData.insert(cacheData.end(), chunks[id].first, chunks[id].first + chunks[id].second);
+        }
+
+        containerData.swap(cacheData);
+    }
+
+    bool WalletCacheJournal::append(
+        const std::string &containerData,
+        const crypto::chacha8_key &key,
+        const std::function<crypto::chacha8_iv()> &nextIv,
+        const std::function<void(const std::string &records)> &write)
+    {
+        if (!m_valid)
+        {
+            return false;
+        }
+
+        const auto *data = reinterpret_cast<const uint8_t *>(containerData.data());
+
+        std::vector<uint64_t> manifest;
+        std::unordered_map<crypto::Hash, uint64_t> newChunkIds;
+        std::vector<std::pair<size_t, size_t>> newChunks;
+        uint64_t newChunksSize = 0;
+        uint64_t chunkCount = m_chunkCount;
+
+        size_t start = 0;
+
+        for (const size_t end : findChunkEnds(data, containerData.size()))
+        {
+            const crypto::Hash hash = chunkId(m_chunkIdKey, data + start, end - start);
+
+            const auto it = m_chunkIds.find(hash);
+            const auto newIt = newChunkIds.find(hash);
+
+            if (it != m_chunkIds.end())
+            {
+                manifest.push_back(it->second);
+            }
+            else if (newIt != newChunkIds.end())
+            {
+                manifest.push_back(newIt->second);
+            }
+            else
+            {
+                newChunkIds.emplace(hash, chunkCount);
+                manifest.push_back(chunkCount++);
+
+                newChunks.emplace_back(start, end - start);
+                newChunksSize += end - start;
+            }
+
+            start = end;
+        }
+
+        /* Nothing changed since the last save */
+        if (manifest == m_manifest)
+        {
+            return true;
+        }
+
+        const uint64_t manifestSize = manifest.size() * sizeof(uint64_t);
+
+        if ((m_appendedSize + newChunksSize + manifestSize) * COMPACTION_DIVISOR > containerData.size())
+        {
+            return false;
+        }
+
+        std::string records;
+
+        for (const auto &chunk : newChunks)
+        {
+            writeRecord(records, CHUNK_RECORD, data + chunk.first, chunk.second, key, nextIv());
+        }
+
+        std::string manifestData;
+
+        {
+            common::StringOutputStream manifestStream(manifestData);
+            BinaryOutputStreamSerializer serializer(manifestStream);
+
+            uint64_t count = manifest.size();
+            serializer(count, "count");
+
+            for (auto id : manifest)
+            {
+                serializer(id, "id");
+            }
+        }
+
+        writeRecord(records, MANIFEST_RECORD, manifestData.data(), manifestData.size(), key, nextIv());
+
+        write(records);
+
+        m_chunkIds.insert(newChunkIds.begin(), newChunkIds.end());
+        m_chunkCount = chunkCount;
+        m_manifest = std::move(manifest);
+        m_appendedSize += records.size();
+
+        return true;
+    }
+
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2019, The Kryptokrona Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mevacoin.h"
+#include "crypto/chacha8.h"
+#include "crypto/hash.h"
+
+namespace mevacoin
+{
+
+    /* Lets the wallet cache be saved without encrypting and writing all of
+       it every time. The container suffix holds a full snapshot of the cache,
+       followed by an append only section. The cache data is split into
+       content defined chunks, and a save only appends the chunks that aren't
+       stored yet, and a manifest listing which chunks make up the cache now.
+       Once the appended section gets too big, the caller writes a new full
+       snapshot in its place. */
+    class WalletCacheJournal
+    {
+    public:
+        WalletCacheJournal();
+
+        /* Forgets what is stored, so the next save writes the whole cache */
+        void clear();
+
+        /* Called after the whole cache was written as the snapshot, with
+           nothing appended after it */
+        void reset(const void *containerData, size_t containerDataSize);
+
+        /* Reads the records appended after the snapshot. containerData holds
+           the snapshot going in, and the cache as last saved coming out.
+           Records cut off by an interrupted save are ignored. */
+        void load(const uint8_t *records, size_t recordsSize, const crypto::chacha8_key &key, BinaryArray &containerData);
+
+        /* Passes the records to append to save this cache data to write().
+           Returns false, without writing anything, if a full snapshot should
+           be written instead. */
+        bool append(
+            const std::string &containerData,
+            const crypto::chacha8_key &key,
+            const std::function<crypto::chacha8_iv()> &nextIv,
+            const std::function<void(const std::string &records)> &write);
+
+    private:
+        bool m_valid;
+
+        /* Chunk ids by the hash of their data. The snapshot chunks come first,
+           then the appended ones, in the order they are stored */
+        std::unordered_map<crypto::Hash, uint64_t> m_chunkIds;
+
+        uint64_t m_chunkCount;
+
+        /* The chunks making up the cache as last saved */
+        std::vector<uint64_t> m_manifest;
+
+        /* Bytes appended after the snapshot */
+        uint64_t m_appendedSize;
+
+        /* Key for the chunk hashes, picked again on clear() */
+        std::array<uint8_t, 32> m_chunkIdKey;
+    };
+
+}
@@ -12,9 +12,11 @@
 #include <ctime>
 #include <cassert>
 #include <fstream>
+#include <future>
 #include <numeric>
 #include <random>
 #include <set>
+#include <thread>
 #include <tuple>
 #include <utility>
 
@@ -215,6 +217,7 @@ namespace mevacoin
         m_blockchainSynchronizer.removeObserver(this);
 
         m_containerStorage.close();
+        m_cacheJournal.clear();
         m_walletsContainer.clear();
 
         clearCaches(true, true);
@@ -637,7 +640,7 @@ namespace mevacoin
         assert(m_containerStorage.isOpened());
 
         BinaryArray contanerData;
-        loadAndDecryptContainerData(m_containerStorage, m_key, contanerData);
+        loadContainerData(contanerData);
 
         WalletSerializerV2 s(
             *this,
@@ -708,8 +711,22 @@ namespace mevacoin
 
         s.save(containerStream, saveLevel);
 
-        encryptAndSaveContainerData(storage, key, containerData.data(), containerData.size());
-        storage.flush();
+        /* Only the parts that changed are appended to our own container. A
+           full snapshot is written when exporting, or when it's time to compact */
+        if (&storage == &m_containerStorage && appendContainerData(key, containerData))
+        {
+            m_logger(DEBUGGING) << "Appended cache changes to container";
+        }
+        else
+        {
+            encryptAndSaveContainerData(storage, key, containerData.data(), containerData.size());
+            storage.flush();
+
+            if (&storage == &m_containerStorage)
+            {
+                m_cacheJournal.reset(containerData.data(), containerData.size());
+            }
+        }
 
         m_extra = extra;
 
@@ -788,7 +805,7 @@ namespace mevacoin
         std::copy(suffix.begin(), suffix.end(), storage.suffix());
     }
 
-    void WalletGreen::loadAndDecryptContainerData(ContainerStorage &storage, const crypto::chacha8_key &key, BinaryArray &containerData)
+    size_t WalletGreen::loadAndDecryptContainerData(ContainerStorage &storage, const crypto::chacha8_key &key, BinaryArray &containerData)
     {
         common::MemoryInputStream suffixStream(storage.suffix(), storage.suffixSize());
         BinaryInputStreamSerializer suffixSerializer(suffixStream);
@@ -799,6 +816,35 @@ namespace mevacoin
 
         containerData.resize(encryptedContainer.size());
         chacha8(encryptedContainer.data(), encryptedContainer.size(), key, suffixIv, reinterpret_cast<char *>(containerData.data()));
+
+        return suffixStream.getPosition();
+    }
+
+    void WalletGreen::loadContainerData(BinaryArray &containerData)
+    {
+        const size_t snapshotSize = loadAndDecryptContainerData(m_containerStorage, m_key, containerData);
+
+        m_cacheJournal.load(m_containerStorage.suffix() + snapshotSize, m_containerStorage.suffixSize() - snapshotSize, m_key, containerData);
+    }
+
+    bool WalletGreen::appendContainerData(const crypto::chacha8_key &key, const std::string &containerData)
+    {
+        return m_cacheJournal.append(
+            containerData,
+            key,
+            [this]()
+            {
+                ContainerStoragePrefix *prefix = reinterpret_cast<ContainerStoragePrefix *>(m_containerStorage.prefix());
+
+                crypto::chacha8_iv iv = prefix->nextIv;
+                incIv(prefix->nextIv);
+
+                return iv;
+            },
+            [this](const std::string &records)
+            {
+                m_containerStorage.appendToSuffix(records.data(), records.size());
+            });
     }
 
     void WalletGreen::initTransactionPool()
@@ -946,10 +992,13 @@ namespace mevacoin
 
     if (m_containerStorage.suffixSize() > 0) {
       BinaryArray containerData;
-      loadAndDecryptContainerData(m_containerStorage, m_key, containerData);
+      loadContainerData(containerData);
       encryptAndSaveContainerData(newStorage, newKey, containerData.data(), containerData.size());
     } });
 
+        /* The new container only has the snapshot */
+        m_cacheJournal.clear();
+
         m_key = newKey;
         m_password = newPassword;
 
@@ -1056,18 +1105,54 @@ namespace mevacoin
     {
         std::vector<NewAddressData> addressDataList(spendSecretKeys.size());
 
-        for (size_t i = 0; i < spendSecretKeys.size(); ++i)
+        /* Deriving the public keys is the slow part of importing a lot of keys.
+           Split it over the available cores, and do it off the dispatcher thread
+           so the other contexts aren't stalled in the meantime. Each chunk hands
+           back the index of the first key it failed on, or the key count. */
+        syst::RemoteContext<size_t> deriveKeys(m_dispatcher, [&spendSecretKeys, &addressDataList]()
         {
-            crypto::PublicKey spendPublicKey;
+            const size_t keyCount = spendSecretKeys.size();
+            const size_t threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+            const size_t chunkSize = std::max<size_t>(1, (keyCount + threadCount - 1) / threadCount);
+
+            std::vector<std::future<size_t>> chunks;
 
-            if (!crypto::secret_key_to_public_key(spendSecretKeys[i], spendPublicKey))
+            for (size_t start = 0; start < keyCount; start += chunkSize)
             {
-                m_logger(ERROR, BRIGHT_RED) << "createAddressList(): failed to convert secret key to public key, secret key " << spendSecretKeys[i];
-                throw std::system_error(make_error_code(mevacoin::error::KEY_GENERATION_ERROR));
+                const size_t end = std::min(start + chunkSize, keyCount);
+
+                chunks.push_back(std::async(std::launch::async, [&spendSecretKeys, &addressDataList, start, end, keyCount]()
+                {
+                    for (size_t i = start; i < end; ++i)
+                    {
+                        addressDataList[i].spendSecretKey = spendSecretKeys[i];
+
+                        if (!crypto::secret_key_to_public_key(spendSecretKeys[i], addressDataList[i].spendPublicKey))
+                        {
+                            return i;
+                        }
+                    }
+
+                    return keyCount;
+                }));
+            }
+
+            size_t failedIndex = keyCount;
+
+            for (auto &chunk : chunks)
+            {
+                failedIndex = std::min(failedIndex, chunk.get());
             }
 
-            addressDataList[i].spendSecretKey = spendSecretKeys[i];
-            addressDataList[i].spendPublicKey = spendPublicKey;
+            return failedIndex;
+        });
+
+        const size_t failedIndex = deriveKeys.get();
+
+        if (failedIndex != spendSecretKeys.size())
+        {
+            m_logger(ERROR, BRIGHT_RED) << "createAddressList(): failed to convert secret key to public key, secret key " << spendSecretKeys[failedIndex];
+            throw std::system_error(make_error_code(mevacoin::error::KEY_GENERATION_ERROR));
         }
 
         return doCreateAddressList(addressDataList, scanHeight, newAddress);
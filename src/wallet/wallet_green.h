@@ -13,6 +13,7 @@
 #include <unordered_map>
 
 #include "ifusion_manager.h"
+#include "wallet_cache_journal.h"
 #include "wallet_indices.h"
 
 #include "logging/logger_ref.h"
@@ -313,7 +314,9 @@ namespace mevacoin
         static void copyContainerStoragePrefix(ContainerStorage &src, const crypto::chacha8_key &srcKey, ContainerStorage &dst, const crypto::chacha8_key &dstKey);
         void deleteOrphanTransactions(const std::unordered_set<crypto::PublicKey> &deletedKeys);
         static void encryptAndSaveContainerData(ContainerStorage &storage, const crypto::chacha8_key &key, const void *containerData, size_t containerDataSize);
-        static void loadAndDecryptContainerData(ContainerStorage &storage, const crypto::chacha8_key &key, BinaryArray &containerData);
+        static size_t loadAndDecryptContainerData(ContainerStorage &storage, const crypto::chacha8_key &key, BinaryArray &containerData);
+        void loadContainerData(BinaryArray &containerData);
+        bool appendContainerData(const crypto::chacha8_key &key, const std::string &containerData);
         void initTransactionPool();
         void loadSpendKeys();
         void loadContainerStorage(const std::string &path);
@@ -362,6 +365,7 @@ namespace mevacoin
 
         WalletsContainer m_walletsContainer;
         ContainerStorage m_containerStorage;
+        WalletCacheJournal m_cacheJournal;
         UnlockTransactionJobs m_unlockTransactionsJob;
         WalletTransactions m_transactions;
         WalletTransfers m_transfers;                               // sorted
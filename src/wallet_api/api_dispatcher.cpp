@@ -34,10 +34,12 @@ ApiDispatcher::ApiDispatcher(
     const uint16_t bindPort,
     const std::string rpcBindIp,
     const std::string rpcPassword,
-    const std::string corsHeader) : m_port(bindPort),
-                                    m_host(rpcBindIp),
-                                    m_corsHeader(corsHeader),
-                                    m_rpcPassword(rpcPassword)
+    const std::string corsHeader,
+    const uint32_t scanThreads) : m_port(bindPort),
+                                  m_host(rpcBindIp),
+                                  m_corsHeader(corsHeader),
+                                  m_rpcPassword(rpcPassword),
+                                  m_scanThreads(scanThreads)
 {
     /* Generate the salt used for pbkdf2 api authentication */
     rnd::randomBytes(16, m_salt);
@@ -170,6 +172,10 @@ ApiDispatcher::ApiDispatcher(
         /* Get the transactions starting at the given block, and ending at the given block */
         .Get("/transactions/\\d+/\\d+", router(&ApiDispatcher::getTransactionsFromHeightToHeight, walletMustBeOpen, viewWalletsAllowed))
 
+        /* Get all transactions belonging to the given address */
+        .Get("/transactions/address/" + api_constants::addressRegex, router(
+                                                                         &ApiDispatcher::getTransactionsForAddress, walletMustBeOpen, viewWalletsAllowed))
+
         /* Get the transactions starting at the given block, for 1000 blocks, belonging to the given address */
         .Get("/transactions/address/" + api_constants::addressRegex + "/\\d+", router(
                                                                                    &ApiDispatcher::getTransactionsFromHeightWithAddress, walletMustBeOpen, viewWalletsAllowed))
@@ -377,6 +383,11 @@ std::tuple<Error, uint16_t> ApiDispatcher::openWallet(
     std::tie(error, m_walletBackend) = WalletBackend::openWallet(
         filename, password, daemonHost, daemonPort);
 
+    if (!error)
+    {
+        m_walletBackend->setScanThreadCount(m_scanThreads);
+    }
+
     return {error, 200};
 }
 
@@ -405,6 +416,11 @@ std::tuple<Error, uint16_t> ApiDispatcher::keyImportWallet(
         privateSpendKey, privateViewKey, filename, password, scanHeight,
         daemonHost, daemonPort);
 
+    if (!error)
+    {
+        m_walletBackend->setScanThreadCount(m_scanThreads);
+    }
+
     return {error, 200};
 }
 
@@ -431,6 +447,11 @@ std::tuple<Error, uint16_t> ApiDispatcher::seedImportWallet(
     std::tie(error, m_walletBackend) = WalletBackend::importWalletFromSeed(
         mnemonicSeed, filename, password, scanHeight, daemonHost, daemonPort);
 
+    if (!error)
+    {
+        m_walletBackend->setScanThreadCount(m_scanThreads);
+    }
+
     return {error, 200};
 }
 
@@ -459,6 +480,11 @@ std::tuple<Error, uint16_t> ApiDispatcher::importViewWallet(
         privateViewKey, address, filename, password, scanHeight,
         daemonHost, daemonPort);
 
+    if (!error)
+    {
+        m_walletBackend->setScanThreadCount(m_scanThreads);
+    }
+
     return {error, 200};
 }
 
@@ -476,6 +502,11 @@ std::tuple<Error, uint16_t> ApiDispatcher::createWallet(
     std::tie(error, m_walletBackend) = WalletBackend::createWallet(
         filename, password, daemonHost, daemonPort);
 
+    if (!error)
+    {
+        m_walletBackend->setScanThreadCount(m_scanThreads);
+    }
+
     return {error, 200};
 }
 
@@ -932,6 +963,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getStatus(
         {"walletBlockCount", status.walletBlockCount},
         {"localDaemonBlockCount", status.localDaemonBlockCount},
         {"networkBlockCount", status.networkBlockCount},
+        {"syncSpeed", status.syncSpeed},
         {"peerCount", status.peerCount},
         {"hashrate", status.lastKnownHashrate},
         {"isViewWallet", m_walletBackend->isViewWallet()},
@@ -1002,14 +1034,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactions(
     Response &res,
     const nlohmann::json &body) const
 {
-    nlohmann::json j{
-        {"transactions", m_walletBackend->getTransactions()}};
-
-    publicKeysToAddresses(j);
-
-    res.set_content(j.dump(4) + "\n", "application/json");
-
-    return {SUCCESS, 200};
+    return sendTransactions(req, res, 0, std::numeric_limits<uint64_t>::max(), std::nullopt);
 }
 
 std::tuple<Error, uint16_t> ApiDispatcher::getUnconfirmedTransactions(
@@ -1076,17 +1101,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeight(
     {
         uint64_t startHeight = std::stoull(startHeightStr);
 
-        const auto txs = m_walletBackend->getTransactionsRange(
-            startHeight, startHeight + 1000);
-
-        nlohmann::json j{
-            {"transactions", txs}};
-
-        publicKeysToAddresses(j);
-
-        res.set_content(j.dump(4) + "\n", "application/json");
-
-        return {SUCCESS, 200};
+        return sendTransactions(req, res, startHeight, startHeight + 1000, std::nullopt);
     }
     catch (const std::out_of_range &)
     {
@@ -1127,17 +1142,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeightToHeight(
             return {SUCCESS, 400};
         }
 
-        const auto txs = m_walletBackend->getTransactionsRange(
-            startHeight, endHeight);
-
-        nlohmann::json j{
-            {"transactions", txs}};
-
-        publicKeysToAddresses(j);
-
-        res.set_content(j.dump(4) + "\n", "application/json");
-
-        return {SUCCESS, 200};
+        return sendTransactions(req, res, startHeight, endHeight, std::nullopt);
     }
     catch (const std::out_of_range &)
     {
@@ -1174,36 +1179,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeightWithAddress(
     {
         uint64_t startHeight = std::stoull(startHeightStr);
 
-        const auto txs = m_walletBackend->getTransactionsRange(
-            startHeight, startHeight + 1000);
-
-        std::vector<wallet_types::Transaction> result;
-
-        std::copy_if(txs.begin(), txs.end(), std::back_inserter(result),
-                     [address, this](const auto tx)
-                     {
-                         for (const auto [key, transfer] : tx.transfers)
-                         {
-                             const auto [error, actualAddress] = m_walletBackend->getAddress(key);
-
-                             /* If the transfer contains our address, keep it, else skip */
-                             if (actualAddress == address)
-                             {
-                                 return true;
-                             }
-                         }
-
-                         return false;
-                     });
-
-        nlohmann::json j{
-            {"transactions", result}};
-
-        publicKeysToAddresses(j);
-
-        res.set_content(j.dump(4) + "\n", "application/json");
-
-        return {SUCCESS, 200};
+        return sendTransactions(req, res, startHeight, startHeight + 1000, address);
     }
     catch (const std::out_of_range &)
     {
@@ -1255,36 +1231,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeightToHeightWith
             return {SUCCESS, 400};
         }
 
-        const auto txs = m_walletBackend->getTransactionsRange(
-            startHeight, endHeight);
-
-        std::vector<wallet_types::Transaction> result;
-
-        std::copy_if(txs.begin(), txs.end(), std::back_inserter(result),
-                     [address, this](const auto tx)
-                     {
-                         for (const auto [key, transfer] : tx.transfers)
-                         {
-                             const auto [error, actualAddress] = m_walletBackend->getAddress(key);
-
-                             /* If the transfer contains our address, keep it, else skip */
-                             if (actualAddress == address)
-                             {
-                                 return true;
-                             }
-                         }
-
-                         return false;
-                     });
-
-        nlohmann::json j{
-            {"transactions", result}};
-
-        publicKeysToAddresses(j);
-
-        res.set_content(j.dump(4) + "\n", "application/json");
-
-        return {SUCCESS, 200};
+        return sendTransactions(req, res, startHeight, endHeight, address);
     }
     catch (const std::out_of_range &)
     {
@@ -1298,6 +1245,21 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeightToHeightWith
     }
 }
 
+std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsForAddress(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const nlohmann::json &body) const
+{
+    std::string address = req.path.substr(std::string("/transactions/address/").size());
+
+    if (Error error = validateAddresses({address}, false); error != SUCCESS)
+    {
+        return {error, 400};
+    }
+
+    return sendTransactions(req, res, 0, std::numeric_limits<uint64_t>::max(), address);
+}
+
 std::tuple<Error, uint16_t> ApiDispatcher::getTransactionDetails(
     const httplib::Request &req,
     httplib::Response &res,
@@ -1309,21 +1271,20 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionDetails(
 
     common::podFromHex(hashStr, hash.data);
 
-    for (const auto tx : m_walletBackend->getTransactions())
+    const auto tx = m_walletBackend->getTransaction(hash);
+
+    /* Not found */
+    if (!tx)
     {
-        if (tx.hash == hash)
-        {
-            nlohmann::json j{
-                {"transaction", tx}};
+        return {SUCCESS, 404};
+    }
 
-            res.set_content(j.dump(4) + "\n", "application/json");
+    nlohmann::json j{
+        {"transaction", *tx}};
 
-            return {SUCCESS, 200};
-        }
-    }
+    res.set_content(j.dump(4) + "\n", "application/json");
 
-    /* Not found */
-    return {SUCCESS, 404};
+    return {SUCCESS, 200};
 }
 
 std::tuple<Error, uint16_t> ApiDispatcher::getBalance(
@@ -1545,6 +1506,81 @@ void ApiDispatcher::publicKeysToAddresses(nlohmann::json &j) const
     }
 }
 
+std::tuple<Error, uint16_t> ApiDispatcher::sendTransactions(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const uint64_t startHeight,
+    const uint64_t endHeight,
+    const std::optional<std::string> address) const
+{
+    const bool paginated = req.has_param("limit") || req.has_param("cursor");
+
+    uint64_t limit = std::numeric_limits<uint64_t>::max();
+
+    std::optional<crypto::Hash> cursor;
+
+    if (req.has_param("limit"))
+    {
+        try
+        {
+            limit = std::stoull(req.get_param_value("limit"));
+        }
+        catch (const std::exception &)
+        {
+            std::cout << "Failed to parse limit parameter..." << std::endl;
+            return {SUCCESS, 400};
+        }
+
+        if (limit == 0)
+        {
+            std::cout << "Limit must be greater than zero..." << std::endl;
+            return {SUCCESS, 400};
+        }
+    }
+    else if (paginated)
+    {
+        limit = api_constants::defaultTransactionsPageSize;
+    }
+
+    if (req.has_param("cursor"))
+    {
+        const std::string cursorStr = req.get_param_value("cursor");
+
+        if (Error error = validateHash(cursorStr); error != SUCCESS)
+        {
+            return {error, 400};
+        }
+
+        crypto::Hash hash;
+
+        common::podFromHex(cursorStr, hash.data);
+
+        cursor = hash;
+    }
+
+    const auto [error, txs, nextCursor] = m_walletBackend->getTransactionsPage(
+        startHeight, endHeight, address, cursor, limit);
+
+    if (error)
+    {
+        return {error, 400};
+    }
+
+    nlohmann::json j{
+        {"transactions", txs}};
+
+    publicKeysToAddresses(j);
+
+    if (paginated)
+    {
+        j["nextCursor"] = nextCursor ? nlohmann::json(common::podToHex(*nextCursor)) : nlohmann::json();
+    }
+
+    res.set_content(j.dump(4) + "\n", "application/json");
+
+    return {SUCCESS, 200};
+}
+
 std::string ApiDispatcher::hashPassword(const std::string password) const
 {
     using namespace CryptoPP;
@@ -49,7 +49,8 @@ public:
         const uint16_t bindPort,
         const std::string rpcBindIp,
         const std::string rpcPassword,
-        std::string corsHeader);
+        std::string corsHeader,
+        const uint32_t scanThreads);
 
     /////////////////////////////
     /* Public member functions */
@@ -277,6 +278,11 @@ private:
         httplib::Response &res,
         const nlohmann::json &body) const;
 
+    std::tuple<Error, uint16_t> getTransactionsForAddress(
+        const httplib::Request &req,
+        httplib::Response &res,
+        const nlohmann::json &body) const;
+
     std::tuple<Error, uint16_t> getTransactionDetails(
         const httplib::Request &req,
         httplib::Response &res,
@@ -334,6 +340,17 @@ private:
     /* Converts a public spend key to an address in a transactions json */
     void publicKeysToAddresses(nlohmann::json &j) const;
 
+    /* Responds with the transactions in the range [startHeight, endHeight - 1],
+       optionally only those belonging to the given address. If the limit
+       and/or cursor query parameters are given, only that page is returned,
+       along with the cursor for the next page. */
+    std::tuple<Error, uint16_t> sendTransactions(
+        const httplib::Request &req,
+        httplib::Response &res,
+        const uint64_t startHeight,
+        const uint64_t endHeight,
+        const std::optional<std::string> address) const;
+
     std::string hashPassword(const std::string password) const;
 
     //////////////////////////////
@@ -365,6 +382,9 @@ private:
        header is not added. */
     std::string m_corsHeader;
 
+    /* Threads used by opened wallets to find their outputs whilst syncing */
+    uint32_t m_scanThreads;
+
     /* Used along with our password with pbkdf2 */
     CryptoPP::byte m_salt[16];
 };
@@ -21,4 +21,7 @@ namespace api_constants
 
     /* 64 char, hex */
     const std::string hashRegex = "[a-fA-F0-9]{64}";
+
+    /* Transactions returned per page when a cursor is given without a limit */
+    const uint64_t defaultTransactionsPageSize = 1000;
 }
@@ -9,6 +9,8 @@
 
 #include <cxxopts.hpp>
 
+#include <thread>
+
 #include <config/cli_header.h>
 #include <config/mevacoin_config.h>
 #include <config/wallet_config.h>
@@ -38,6 +40,9 @@ Config parseArguments(int argc, char **argv)
 
         ("r,rpc-password", "Specify the <password> to access the RPC server.", cxxopts::value<std::string>(config.rpcPassword), "<password>");
 
+    options.add_options("Wallet")("scan-threads", "The number of threads to use to find transactions belonging to the wallet whilst syncing",
+                                  cxxopts::value<uint32_t>(config.scanThreads)->default_value(std::to_string(std::max(1u, std::thread::hardware_concurrency()))), "<threads>");
+
     try
     {
         const auto result = options.parse(argc, argv);
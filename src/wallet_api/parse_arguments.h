@@ -20,6 +20,9 @@ struct Config
 
     /* The value to use with the 'Access-Control-Allow-Origin' header */
     std::string corsHeader;
+
+    /* How many threads to use to find our outputs whilst syncing */
+    uint32_t scanThreads;
 };
 
 Config parseArguments(int argc, char **argv);
@@ -35,6 +35,14 @@ namespace Constants
        upgrade the wallet format in the future) */
     const uint16_t WALLET_FILE_FORMAT_VERSION = 0;
 
+    /* Added to the wallet filename to get the filename of its journal,
+       which the wallet is saved to between full saves */
+    const std::string WALLET_JOURNAL_SUFFIX = ".journal";
+
+    /* The whole wallet is saved, and the journal removed, once the journal
+       is larger than this, or than the wallet file, whichever is larger */
+    const uint64_t MINIMUM_JOURNAL_COMPACTION_SIZE = 1024 * 1024;
+
     /* How large should the m_lastKnownBlockHashes container be */
     const uint32_t LAST_KNOWN_BLOCK_HASHES_SIZE = 100;
 
@@ -57,6 +65,9 @@ namespace Constants
        amount. */
     const uint32_t MAXIMUM_SYNC_QUEUE_SIZE = 1000;
 
+    /* How often the sync speed reported by getSyncStatus() is updated */
+    const uint64_t SYNC_SPEED_WINDOW_SECONDS = 10;
+
     /* Handy if we don't want to use a secret key (for example, for view wallets)
        and want to make it explicit that this is uninitialized. */
     const crypto::SecretKey BLANK_SECRET_KEY = crypto::SecretKey({
@@ -413,19 +413,19 @@ namespace send_transaction
 
         uint64_t outputIndex = 0;
 
-        for (const auto output : keyOutputs)
+        const auto spendKeys = subWallets->getPublicSpendKeySet();
+
+        for (const auto &output : keyOutputs)
         {
             crypto::PublicKey spendKey;
 
             /* Not our output */
             crypto::underive_public_key(derivation, outputIndex, output.key, spendKey);
 
-            const auto spendKeys = subWallets->m_publicSpendKeys;
-
             /* See if the derived spend key is one of ours */
-            const auto it = std::find(spendKeys.begin(), spendKeys.end(), spendKey);
+            const auto it = spendKeys->find(spendKey);
 
-            if (it != spendKeys.end())
+            if (it != spendKeys->end())
             {
                 crypto::PublicKey ourSpendKey = *it;
 
@@ -890,20 +890,22 @@ namespace send_transaction
                 publicKeys.push_back(output.key);
             }
 
+            /* Make space for the signatures in the transaction, so they can be
+               written in place */
+            auto &signatures = tx.signatures.emplace_back(publicKeys.size());
+
             /* Generate the ring signatures - note - modifying the transaction
                post signature generation will invalidate the signatures. */
-            const auto [success, signatures] = crypto::crypto_ops::generateRingSignatures(
+            const bool success = crypto::crypto_ops::generateRingSignatures(
                 txPrefixHash, boost::get<mevacoin::KeyInput>(tx.inputs[i]).keyImage,
-                publicKeys, tmpSecretKeys[i], input.realOutput);
+                {publicKeys.data(), publicKeys.size()}, tmpSecretKeys[i], input.realOutput,
+                {signatures.data(), signatures.size()});
 
             if (!success)
             {
                 return {FAILED_TO_CREATE_RING_SIGNATURE, tx};
             }
 
-            /* Add the signatures to the transaction */
-            tx.signatures.push_back(signatures);
-
             i++;
         }
 
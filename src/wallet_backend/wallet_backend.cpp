@@ -19,6 +19,7 @@
 
 #include <cryptopp/aes.h>
 #include <cryptopp/algparam.h>
+#include <cryptopp/files.h>
 #include <cryptopp/filters.h>
 #include <cryptopp/modes.h>
 #include <cryptopp/sha.h>
@@ -102,6 +103,90 @@ namespace
         return SUCCESS;
     }
 
+    /* Generates the key the wallet is encrypted with from the password,
+       using PBKDF2. This is deliberately slow, to slow down brute forcing */
+    std::array<uint8_t, 16> deriveWalletKey(
+        const std::string &password,
+        const std::array<uint8_t, 16> &salt)
+    {
+        std::array<uint8_t, 16> key;
+
+        /* Using SHA256 as the algorithm */
+        CryptoPP::PKCS5_PBKDF2_HMAC<CryptoPP::SHA256> pbkdf2;
+
+        pbkdf2.DeriveKey(
+            key.data(), key.size(), 0, (const uint8_t *)password.c_str(),
+            password.size(), salt.data(), salt.size(), Constants::PBKDF2_ITERATIONS);
+
+        return key;
+    }
+
+    /* Encrypts the data with AES into the sink, after the isCorrectPassword
+       identifier, so we can tell if it has been decrypted correctly. The
+       data is fed through the cipher as is, without making a copy of it
+       with the identifier added. */
+    void encryptWalletData(
+        const char *data,
+        const size_t size,
+        const std::array<uint8_t, 16> &key,
+        const std::array<uint8_t, 16> &iv,
+        CryptoPP::BufferedTransformation *sink)
+    {
+        using namespace CryptoPP;
+
+        CBC_Mode<AES>::Encryption cbcEncryption;
+
+        cbcEncryption.SetKeyWithIV(key.data(), key.size(), iv.data());
+
+        /* Takes ownership of the sink */
+        StreamTransformationFilter filter(cbcEncryption, sink);
+
+        filter.Put(
+            (const byte *)Constants::IS_CORRECT_PASSWORD_IDENTIFIER.data(),
+            Constants::IS_CORRECT_PASSWORD_IDENTIFIER.size());
+
+        filter.Put((const byte *)data, size);
+
+        /* Pad and flush */
+        filter.MessageEnd();
+    }
+
+    /* Reverses encryptWalletData(). The encrypted data is read by a CryptoPP
+       source (ArraySource, FileSource, ...) created from the input, so it
+       doesn't have to be in memory all at once. */
+    template <typename Source, typename... Input>
+    Error decryptWalletData(
+        const std::array<uint8_t, 16> &key,
+        const std::array<uint8_t, 16> &iv,
+        std::string &decryptedData,
+        Input &&... input)
+    {
+        using namespace CryptoPP;
+
+        CBC_Mode<AES>::Decryption cbcDecryption;
+
+        cbcDecryption.SetKeyWithIV(key.data(), key.size(), iv.data());
+
+        try
+        {
+            /* Decrypt, handling padding */
+            Source(std::forward<Input>(input)..., true, new StreamTransformationFilter(cbcDecryption, new StringSink(decryptedData)));
+        }
+        /* do NOT report an alternate error for invalid padding. It allows them
+           to do a padding oracle attack, I believe. Just report the wrong password
+           error. */
+        catch (const CryptoPP::Exception &)
+        {
+            return WRONG_PASSWORD;
+        }
+
+        /* Check that the decrypted data has the 'isCorrectPassword' identifier,
+           and remove it it does. If it doesn't, return an error. */
+        return hasMagicIdentifier(
+            decryptedData, Constants::IS_CORRECT_PASSWORD_IDENTIFIER,
+            WALLET_FILE_CORRUPTED, WRONG_PASSWORD);
+    }
+
 } // namespace
 
 ///////////////////////////////////
@@ -381,75 +466,45 @@ std::tuple<Error, std::shared_ptr<WalletBackend>> WalletBackend::openWallet(
         return {FILENAME_NON_EXISTENT, nullptr};
     }
 
-    /* Read file into a buffer */
-    std::vector<char> buffer((std::istreambuf_iterator<char>(file)),
-                             (std::istreambuf_iterator<char>()));
+    std::error_code ec;
+
+    const uint64_t fileSize = fs::file_size(filename, ec);
 
-    /* Check that the decrypted data has the 'isAWallet' identifier,
-       and remove it it does. If it doesn't, return an error. */
+    /* Just read the unencrypted header - the rest is decrypted straight
+       from the file */
+    std::vector<char> identifier(Constants::IS_A_WALLET_IDENTIFIER.size());
+
+    file.read(identifier.data(), identifier.size());
+
+    /* Check that the file has the 'isAWallet' identifier. If it doesn't,
+       return an error. */
     Error error = hasMagicIdentifier(
-        buffer, Constants::IS_A_WALLET_IDENTIFIER,
+        identifier, Constants::IS_A_WALLET_IDENTIFIER,
         NOT_A_WALLET_FILE, NOT_A_WALLET_FILE);
 
-    if (error)
+    if (!file || error)
     {
-        return {error, nullptr};
+        return {NOT_A_WALLET_FILE, nullptr};
     }
 
-    using namespace CryptoPP;
-
     /* The salt we use for both PBKDF2, and AES decryption */
-    byte salt[16];
+    std::array<uint8_t, 16> salt;
+
+    file.read((char *)salt.data(), salt.size());
 
     /* Check the file is large enough for the salt */
-    if (buffer.size() < sizeof(salt))
+    if (!file)
     {
         return {WALLET_FILE_CORRUPTED, nullptr};
     }
 
-    /* Copy the salt to the salt array */
-    std::copy(buffer.begin(), buffer.begin() + sizeof(salt), salt);
-
-    /* Remove the salt, don't need it anymore */
-    buffer.erase(buffer.begin(), buffer.begin() + sizeof(salt));
-
     /* The key we use for AES decryption, generated with PBKDF2 */
-    byte key[16];
-
-    /* Using SHA256 as the algorithm */
-    CryptoPP::PKCS5_PBKDF2_HMAC<CryptoPP::SHA256> pbkdf2;
-
-    /* Generate the AES Key using pbkdf2 */
-    pbkdf2.DeriveKey(
-        key, sizeof(key), 0, (byte *)password.c_str(),
-        password.size(), salt, sizeof(salt), Constants::PBKDF2_ITERATIONS);
-
-    CBC_Mode<AES>::Decryption cbcDecryption;
-
-    /* Initialize our decrypter with the key and salt/iv */
-    cbcDecryption.SetKeyWithIV(key, sizeof(key), salt);
+    const auto key = deriveWalletKey(password, salt);
 
     /* This will store the decrypted data */
     std::string decryptedData;
 
-    try
-    {
-        /* Decrypt, handling padding */
-        StringSource((byte *)buffer.data(), buffer.size(), true, new StreamTransformationFilter(cbcDecryption, new StringSink(decryptedData)));
-    }
-    /* do NOT report an alternate error for invalid padding. It allows them
-       to do a padding oracle attack, I believe. Just report the wrong password
-       error. */
-    catch (const CryptoPP::Exception &)
-    {
-        return {WRONG_PASSWORD, nullptr};
-    }
-
-    /* Check that the decrypted data has the 'isCorrectPassword' identifier,
-       and remove it it does. If it doesn't, return an error. */
-    error = hasMagicIdentifier(
-        decryptedData, Constants::IS_CORRECT_PASSWORD_IDENTIFIER,
-        WALLET_FILE_CORRUPTED, WRONG_PASSWORD);
+    error = decryptWalletData<CryptoPP::FileSource>(key, salt, decryptedData, file);
 
     if (error)
     {
@@ -469,7 +524,9 @@ std::tuple<Error, std::shared_ptr<WalletBackend>> WalletBackend::openWallet(
 
         rapidjson::Document walletJson;
 
-        if (walletJson.Parse(decryptedData.c_str()).HasParseError())
+        /* Parse in place, so strings in the document point into the
+           decrypted data rather than being copied */
+        if (walletJson.ParseInsitu(decryptedData.data()).HasParseError())
         {
             return {WALLET_FILE_CORRUPTED, nullptr};
         }
@@ -477,6 +534,12 @@ std::tuple<Error, std::shared_ptr<WalletBackend>> WalletBackend::openWallet(
         /* Make our wallet object */
         const auto wallet = std::make_shared<WalletBackend>();
 
+        /* Keep the key, so we can append to the journal of this file
+           without running PBKDF2 again */
+        wallet->m_walletKey = key;
+        wallet->m_walletSalt = salt;
+        wallet->m_walletFileSize = fileSize;
+
         /* Initialize it from the json (We could do this in less steps, but it
            requires a move/copy constructor) */
         error = wallet->fromJSON(
@@ -541,54 +604,66 @@ Error WalletBackend::save() const
    blockchain synchronizer first (Call save()) */
 Error WalletBackend::unsafeSave() const
 {
-    /* Add an identifier to the start of the string so we can verify the wallet
-       has been correctly decrypted */
-    std::string identiferAsString(
-        Constants::IS_CORRECT_PASSWORD_IDENTIFIER.begin(),
-        Constants::IS_CORRECT_PASSWORD_IDENTIFIER.end());
+    /* Once the journal is larger than the wallet file it's faster to save
+       everything than to replay it on the next open */
+    const uint64_t compactionSize = std::max(
+        Constants::MINIMUM_JOURNAL_COMPACTION_SIZE, m_walletFileSize);
+
+    if (m_canAppendToJournal && m_journalFileSize < compactionSize)
+    {
+        StringBuffer sb;
+        Writer<StringBuffer> writer(sb);
+
+        writer.StartObject();
 
-    /* Add magic identifier, and get wallet as a JSON string */
-    std::string walletData = identiferAsString + this->toJSON();
+        writer.Key("entries");
 
-    using namespace CryptoPP;
+        if (m_subWallets->takeJournal(writer))
+        {
+            writer.Key("walletSynchronizer");
+            m_walletSynchronizer->toJSON(writer);
 
-    /* The key we use for AES encryption, generated with PBKDF2 */
-    byte key[16];
+            writer.EndObject();
 
-    /* The salt we use for both PBKDF2, and AES Encryption */
-    byte salt[16];
+            if (appendToJournal(sb.GetString()) == SUCCESS)
+            {
+                return SUCCESS;
+            }
+        }
+    }
 
-    /* Generate 16 random bytes for the salt */
-    rnd::randomBytes(16, salt);
+    return saveWalletFile();
+}
 
-    /* Using SHA256 as the algorithm */
-    CryptoPP::PKCS5_PBKDF2_HMAC<CryptoPP::SHA256> pbkdf2;
+Error WalletBackend::saveWalletFile() const
+{
+    /* The journal is only valid for the file we're replacing */
+    m_canAppendToJournal = false;
 
-    /* Generate the AES Key using pbkdf2 */
-    pbkdf2.DeriveKey(
-        key, sizeof(key), 0, (byte *)m_password.c_str(),
-        m_password.size(), salt, sizeof(salt), Constants::PBKDF2_ITERATIONS);
+    /* Generate 16 random bytes for the salt, which is also the IV */
+    rnd::randomBytes(m_walletSalt.size(), m_walletSalt.data());
 
-    CBC_Mode<AES>::Encryption cbcEncryption;
+    m_walletKey = deriveWalletKey(m_password, m_walletSalt);
 
-    /* Initialize our encryptor with the key and salt/iv */
-    cbcEncryption.SetKeyWithIV(key, sizeof(key), salt);
+    /* Anything journaled so far is in the JSON we're about to write */
+    m_subWallets->clearJournal();
 
-    /* This will store the encrypted data */
-    std::string encryptedData;
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
 
-    /* Encrypt, and pad */
-    StringSource(walletData, true, new StreamTransformationFilter(cbcEncryption, new StringSink(encryptedData)));
+    toJSON(writer);
 
-    std::ofstream file(m_filename, std::ios_base::binary);
+    /* Write to a temporary file and then replace the wallet with it, so we
+       don't lose the wallet if we crash half way through writing */
+    const std::string tmpFilename = m_filename + ".tmp";
+
+    std::ofstream file(tmpFilename, std::ios_base::binary | std::ios_base::trunc);
 
     if (!file)
     {
         return INVALID_WALLET_FILENAME;
     }
 
-    std::string saltString = std::string(salt, salt + sizeof(salt));
-
     /* Write the isAWalletIdentifier to the file, so when we open it we can
        verify that it is a wallet file */
     std::copy(Constants::IS_A_WALLET_IDENTIFIER.begin(),
@@ -597,12 +672,198 @@ Error WalletBackend::unsafeSave() const
 
     /* Write the salt to the file, so we can use it to unencrypt the file
        later. Note that the salt is unencrypted. */
-    std::copy(std::begin(salt), std::end(salt),
+    std::copy(m_walletSalt.begin(), m_walletSalt.end(),
               std::ostreambuf_iterator<char>(file));
 
-    /* Write the encrypted wallet data to the file */
-    std::copy(encryptedData.begin(), encryptedData.end(),
-              std::ostreambuf_iterator<char>(file));
+    /* Encrypt the wallet data straight into the file */
+    encryptWalletData(
+        sb.GetString(), sb.GetSize(), m_walletKey, m_walletSalt,
+        new CryptoPP::FileSink(file));
+
+    m_walletFileSize = file.tellp();
+
+    file.close();
+
+    if (!file)
+    {
+        return INVALID_WALLET_FILENAME;
+    }
+
+    std::error_code ec;
+
+    fs::rename(tmpFilename, m_filename, ec);
+
+    if (ec)
+    {
+        return INVALID_WALLET_FILENAME;
+    }
+
+    /* If this fails, the journal is ignored on the next open, since it
+       was written with a different salt */
+    fs::remove(m_filename + Constants::WALLET_JOURNAL_SUFFIX, ec);
+
+    m_journalFileSize = 0;
+    m_canAppendToJournal = true;
+
+    return SUCCESS;
+}
+
+/* The journal starts with the salt of the wallet file it belongs to,
+   followed by the saves made since the wallet file was written. Each
+   is stored as its length, a random IV, and the encrypted JSON. */
+Error WalletBackend::appendToJournal(const std::string &data) const
+{
+    std::array<uint8_t, 16> iv;
+
+    rnd::randomBytes(iv.size(), iv.data());
+
+    std::string encryptedData;
+
+    encryptWalletData(
+        data.data(), data.size(), m_walletKey, iv,
+        new CryptoPP::StringSink(encryptedData));
+
+    const uint32_t entrySize = static_cast<uint32_t>(iv.size() + encryptedData.size());
+
+    /* Start a new journal if there isn't one for the current wallet file */
+    const auto mode = m_journalFileSize == 0
+        ? std::ios_base::binary | std::ios_base::trunc
+        : std::ios_base::binary | std::ios_base::app;
+
+    std::ofstream file(m_filename + Constants::WALLET_JOURNAL_SUFFIX, mode);
+
+    if (!file)
+    {
+        return INVALID_WALLET_FILENAME;
+    }
+
+    uint64_t written = 0;
+
+    if (m_journalFileSize == 0)
+    {
+        file.write((const char *)m_walletSalt.data(), m_walletSalt.size());
+        written += m_walletSalt.size();
+    }
+
+    const uint8_t sizeBytes[4] = {
+        static_cast<uint8_t>(entrySize),
+        static_cast<uint8_t>(entrySize >> 8),
+        static_cast<uint8_t>(entrySize >> 16),
+        static_cast<uint8_t>(entrySize >> 24)};
+
+    file.write((const char *)sizeBytes, sizeof(sizeBytes));
+    file.write((const char *)iv.data(), iv.size());
+    file.write(encryptedData.data(), encryptedData.size());
+
+    file.close();
+
+    if (!file)
+    {
+        /* We don't know how much made it to disk, so save the whole
+           wallet next time */
+        m_canAppendToJournal = false;
+
+        return INVALID_WALLET_FILENAME;
+    }
+
+    m_journalFileSize += written + sizeof(sizeBytes) + entrySize;
+
+    return SUCCESS;
+}
+
+Error WalletBackend::loadJournal()
+{
+    const std::string journalFilename = m_filename + Constants::WALLET_JOURNAL_SUFFIX;
+
+    m_journalFileSize = 0;
+    m_canAppendToJournal = true;
+
+    std::ifstream file(journalFilename, std::ios_base::binary);
+
+    if (!file)
+    {
+        return SUCCESS;
+    }
+
+    const std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)),
+                                      (std::istreambuf_iterator<char>()));
+
+    file.close();
+
+    std::error_code ec;
+
+    /* Left over from before the wallet file was last replaced */
+    if (buffer.size() < m_walletSalt.size()
+        || !std::equal(m_walletSalt.begin(), m_walletSalt.end(), buffer.begin()))
+    {
+        fs::remove(journalFilename, ec);
+        return SUCCESS;
+    }
+
+    size_t offset = m_walletSalt.size();
+
+    std::array<uint8_t, 16> iv;
+
+    while (buffer.size() - offset >= 4 + iv.size())
+    {
+        const uint32_t entrySize = buffer[offset]
+                                 | (buffer[offset + 1] << 8)
+                                 | (buffer[offset + 2] << 16)
+                                 | (static_cast<uint32_t>(buffer[offset + 3]) << 24);
+
+        /* Cut short by a crash while saving */
+        if (entrySize < iv.size() || buffer.size() - offset - 4 < entrySize)
+        {
+            break;
+        }
+
+        std::copy(buffer.begin() + offset + 4, buffer.begin() + offset + 4 + iv.size(), iv.begin());
+
+        std::string decryptedData;
+
+        const Error error = decryptWalletData<CryptoPP::ArraySource>(
+            m_walletKey, iv, decryptedData,
+            buffer.data() + offset + 4 + iv.size(), entrySize - iv.size());
+
+        if (error)
+        {
+            break;
+        }
+
+        rapidjson::Document j;
+
+        if (j.ParseInsitu(decryptedData.data()).HasParseError())
+        {
+            break;
+        }
+
+        try
+        {
+            m_subWallets->applyJournal(getJsonValue(j, "entries"));
+
+            m_walletSynchronizer = std::make_shared<WalletSynchronizer>();
+            m_walletSynchronizer->fromJSON(getObjectFromJSON(j, "walletSynchronizer"));
+        }
+        catch (const std::exception &)
+        {
+            return WALLET_FILE_CORRUPTED;
+        }
+
+        offset += 4 + entrySize;
+    }
+
+    /* Drop whatever we couldn't read, so we can append after it */
+    if (offset != buffer.size())
+    {
+        fs::resize_file(journalFilename, offset, ec);
+
+        if (ec)
+        {
+            m_canAppendToJournal = false;
+        }
+    }
+
+    m_journalFileSize = offset;
 
     return SUCCESS;
 }
@@ -812,7 +1073,7 @@ uint64_t WalletBackend::getWalletCount() const
     return m_subWallets->getWalletCount();
 }
 
-std::tuple<uint64_t, uint64_t, uint64_t> WalletBackend::getSyncStatus() const
+std::tuple<uint64_t, uint64_t, uint64_t, double> WalletBackend::getSyncStatus() const
 {
     /* The last block the wallet has synced */
     uint64_t walletBlockCount = m_walletSynchronizer->getCurrentScanHeight();
@@ -823,7 +1084,10 @@ std::tuple<uint64_t, uint64_t, uint64_t> WalletBackend::getSyncStatus() const
     /* The last block on the network, that the daemon is aware of */
     uint64_t networkBlockCount = m_daemon->networkBlockCount();
 
-    return {walletBlockCount, localDaemonBlockCount, networkBlockCount};
+    /* How fast the wallet is scanning blocks */
+    double syncSpeed = m_walletSynchronizer->getSyncSpeed();
+
+    return {walletBlockCount, localDaemonBlockCount, networkBlockCount, syncSpeed};
 }
 
 std::string WalletBackend::getWalletPassword() const
@@ -842,6 +1106,9 @@ Error WalletBackend::changePassword(const std::string newPassword)
 
     m_password = newPassword;
 
+    /* The journal is encrypted with the key from the old password */
+    m_canAppendToJournal = false;
+
     return save();
 }
 
@@ -910,13 +1177,14 @@ std::vector<wallet_types::Transaction> WalletBackend::getUnconfirmedTransactions
 
 wallet_types::WalletStatus WalletBackend::getStatus() const
 {
-    const auto [walletBlockCount, localDaemonBlockCount, networkBlockCount] = getSyncStatus();
+    const auto [walletBlockCount, localDaemonBlockCount, networkBlockCount, syncSpeed] = getSyncStatus();
 
     wallet_types::WalletStatus status;
 
     status.walletBlockCount = walletBlockCount;
     status.localDaemonBlockCount = localDaemonBlockCount;
     status.networkBlockCount = networkBlockCount;
+    status.syncSpeed = syncSpeed;
 
     status.peerCount = m_daemon->peerCount();
     status.lastKnownHashrate = m_daemon->hashrate();
@@ -929,17 +1197,37 @@ wallet_types::WalletStatus WalletBackend::getStatus() const
 std::vector<wallet_types::Transaction> WalletBackend::getTransactionsRange(
     const uint64_t startHeight, const uint64_t endHeight) const
 {
-    std::vector<wallet_types::Transaction> result;
+    return m_subWallets->getTransactionsRange(startHeight, endHeight);
+}
+
+std::tuple<Error, std::vector<wallet_types::Transaction>, std::optional<crypto::Hash>> WalletBackend::getTransactionsPage(
+    const uint64_t startHeight,
+    const uint64_t endHeight,
+    const std::optional<std::string> address,
+    const std::optional<crypto::Hash> cursor,
+    const uint64_t limit) const
+{
+    std::optional<crypto::PublicKey> publicSpendKey;
 
-    const auto transactions = getTransactions();
+    if (address)
+    {
+        /* Verify the address is good, and one of our subwallets */
+        if (Error error = validateOurAddresses({*address}, m_subWallets); error != SUCCESS)
+        {
+            return {error, {}, std::nullopt};
+        }
 
-    std::copy_if(transactions.begin(), transactions.end(), std::back_inserter(result),
-                 [&startHeight, &endHeight](const auto tx)
-                 {
-                     return tx.blockHeight >= startHeight && tx.blockHeight < endHeight;
-                 });
+        const auto [spendKey, viewKey] = utilities::addressToKeys(*address);
 
-    return result;
+        publicSpendKey = spendKey;
+    }
+
+    return m_subWallets->getTransactionsPage(startHeight, endHeight, publicSpendKey, cursor, limit);
+}
+
+std::optional<wallet_types::Transaction> WalletBackend::getTransaction(const crypto::Hash &hash) const
+{
+    return m_subWallets->getTransaction(hash);
 }
 
 std::tuple<uint64_t, std::string> WalletBackend::getNodeFee() const
@@ -965,6 +1253,16 @@ void WalletBackend::swapNode(std::string daemonHost, uint16_t daemonPort)
         return 0; });
 }
 
+void WalletBackend::setScanThreadCount(const size_t threadCount)
+{
+    m_syncRAIIWrapper->pauseSynchronizerToRunFunction([&, this]()
+                                                      {
+        /* The new thread pool is made when the synchronizer starts again */
+        m_walletSynchronizer->setScanThreadCount(threadCount);
+
+        return 0; });
+}
+
 bool WalletBackend::daemonOnline() const
 {
     return m_daemon->isOnline();
@@ -999,6 +1297,13 @@ std::string WalletBackend::toJSON() const
     StringBuffer sb;
     Writer<StringBuffer> writer(sb);
 
+    toJSON(writer);
+
+    return sb.GetString();
+}
+
+void WalletBackend::toJSON(rapidjson::Writer<rapidjson::StringBuffer> &writer) const
+{
     writer.StartObject();
 
     writer.Key("walletFileFormatVersion");
@@ -1011,8 +1316,6 @@ std::string WalletBackend::toJSON() const
     m_walletSynchronizer->toJSON(writer);
 
     writer.EndObject();
-
-    return sb.GetString();
 }
 
 Error WalletBackend::fromJSON(const rapidjson::Document &j)
@@ -1048,6 +1351,11 @@ Error WalletBackend::fromJSON(
     m_filename = filename;
     m_password = password;
 
+    if (Error error = loadJournal(); error != SUCCESS)
+    {
+        return error;
+    }
+
     m_daemon = std::make_shared<Nigel>(daemonHost, daemonPort);
 
     init();
@@ -7,9 +7,15 @@
 
 #include "crypto_types.h"
 
+#include <array>
+
 #include <errors/errors.h>
 
 #include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <optional>
 
 #include <string>
 
@@ -116,6 +122,9 @@ public:
     /* Converts the class to a json string */
     std::string toJSON() const;
 
+    /* Writes the class as json, without copying it out of the writer */
+    void toJSON(rapidjson::Writer<rapidjson::StringBuffer> &writer) const;
+
     /* Initializes the class from a json string */
     Error fromJSON(const rapidjson::Document &j);
 
@@ -196,8 +205,8 @@ public:
     uint64_t getWalletCount() const;
 
     /* wallet sync height, local blockchain sync height,
-       remote blockchain sync height */
-    std::tuple<uint64_t, uint64_t, uint64_t> getSyncStatus() const;
+       remote blockchain sync height, wallet sync speed in blocks per second */
+    std::tuple<uint64_t, uint64_t, uint64_t, double> getSyncStatus() const;
 
     /* Get the wallet password */
     std::string getWalletPassword() const;
@@ -236,6 +245,20 @@ public:
     std::vector<wallet_types::Transaction> getTransactionsRange(
         const uint64_t startHeight, const uint64_t endHeight) const;
 
+    /* Returns up to limit transactions in the range
+       [startHeight, endHeight - 1], oldest first, optionally only those
+       belonging to the given address. Pass the returned cursor back in to
+       get the next page - it is empty on the last page. */
+    std::tuple<Error, std::vector<wallet_types::Transaction>, std::optional<crypto::Hash>> getTransactionsPage(
+        const uint64_t startHeight,
+        const uint64_t endHeight,
+        const std::optional<std::string> address,
+        const std::optional<crypto::Hash> cursor,
+        const uint64_t limit) const;
+
+    /* Gets the (confirmed) transaction with the given hash, if we have it */
+    std::optional<wallet_types::Transaction> getTransaction(const crypto::Hash &hash) const;
+
     /* Get the node fee and address ({0, ""} if empty) */
     std::tuple<uint64_t, std::string> getNodeFee() const;
 
@@ -245,6 +268,9 @@ public:
     /* Swap to a different daemon node */
     void swapNode(std::string daemonHost, uint16_t daemonPort);
 
+    /* Set how many threads are used to find our outputs whilst syncing */
+    void setScanThreadCount(const size_t threadCount);
+
     /* Whether we have recieved info from the daemon at some point */
     bool daemonOnline() const;
 
@@ -294,6 +320,17 @@ private:
 
     Error unsafeSave() const;
 
+    /* Replaces the wallet file with the whole wallet, and removes the
+       journal */
+    Error saveWalletFile() const;
+
+    /* Appends the changes since the last save to the journal, rather than
+       rewriting the whole wallet */
+    Error appendToJournal(const std::string &data) const;
+
+    /* Replays the journal on top of the wallet file we were loaded from */
+    Error loadJournal();
+
     void init();
 
     //////////////////////////////
@@ -306,6 +343,23 @@ private:
     /* The password the wallet is encrypted with */
     std::string m_password;
 
+    /* The key derived from the password and the salt of the wallet file.
+       Deriving it is slow, so it's kept for appending to the journal, and
+       only derived again when the wallet file is replaced. Saving doesn't
+       change the wallet, hence mutable. */
+    mutable std::array<uint8_t, 16> m_walletKey;
+
+    /* The salt of the wallet file, which the journal must start with */
+    mutable std::array<uint8_t, 16> m_walletSalt;
+
+    /* If the wallet file and journal on disk are up to date with the
+       subwallets, except for the changes they have journaled since */
+    mutable bool m_canAppendToJournal = false;
+
+    mutable uint64_t m_walletFileSize = 0;
+
+    mutable uint64_t m_journalFileSize = 0;
+
     /* The sub wallets container (Using a shared_ptr here so
        the WalletSynchronizer has access to it) */
     std::shared_ptr<SubWallets> m_subWallets;
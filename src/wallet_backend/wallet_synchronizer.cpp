@@ -27,6 +27,7 @@
 
 /* Default constructor */
 WalletSynchronizer::WalletSynchronizer() : m_shouldStop(false),
+                                           m_downloadGeneration(0),
                                            m_startTimestamp(0),
                                            m_startHeight(0)
 {
@@ -42,6 +43,7 @@ WalletSynchronizer::WalletSynchronizer(
 
                                                         m_daemon(daemon),
                                                         m_shouldStop(false),
+                                                        m_downloadGeneration(0),
                                                         m_startHeight(startHeight),
                                                         m_startTimestamp(startTimestamp),
                                                         m_privateViewKey(privateViewKey),
@@ -63,8 +65,12 @@ WalletSynchronizer &WalletSynchronizer::operator=(WalletSynchronizer &&old)
     stop();
 
     m_syncThread = std::move(old.m_syncThread);
+    m_downloadThread = std::move(old.m_downloadThread);
 
     m_syncStatus = std::move(old.m_syncStatus);
+    m_downloadStatus = std::move(old.m_downloadStatus);
+
+    m_scanThreadCount = old.m_scanThreadCount;
 
     m_startTimestamp = std::move(old.m_startTimestamp);
     m_startHeight = std::move(old.m_startHeight);
@@ -92,16 +98,83 @@ void WalletSynchronizer::mainLoop()
 {
     while (!m_shouldStop)
     {
+        /* Blocks until the downloader has a block for us, or we're stopping */
+        const QueuedBlock queued = m_blockQueue.pop();
+
+        if (m_shouldStop)
+        {
+            return;
+        }
+
+        /* Queued before the downloader started again from our current
+           height, the block after ours will come through again */
+        if (queued.generation != m_downloadGeneration)
+        {
+            continue;
+        }
+
+        /* Waits for the scan thread pool to get to this block, if it hasn't
+           already. Blocks are always processed in order. */
+        if (!processBlock(*queued.block, queued.ourInputs.get()))
+        {
+            /* Get the downloader to start again from the last block we
+               processed, and throw away what it already queued */
+            m_downloadGeneration++;
+            continue;
+        }
+
+        /* Let API requests see the blocks we've processed, without them
+           having to wait on us for every block */
+        if (queued.lastInBatch)
+        {
+            m_subWallets->publishSnapshot(m_daemon->networkBlockCount());
+        }
+
+        updateSyncSpeed();
+    }
+}
+
+void WalletSynchronizer::downloaderLoop()
+{
+    uint64_t generation = m_downloadGeneration;
+
+    while (!m_shouldStop)
+    {
+        /* The scanner couldn't use the blocks we queued, start again from
+           where it got to. It won't process anything until we push blocks
+           of the new generation, so it's safe to read its status. */
+        if (generation != m_downloadGeneration)
+        {
+            generation = m_downloadGeneration;
+            m_downloadStatus = m_syncStatus;
+        }
+
         const auto blocks = downloadBlocks();
 
-        for (const auto block : blocks)
+        for (const auto &block : blocks)
         {
-            if (m_shouldStop)
+            if (m_shouldStop || generation != m_downloadGeneration)
             {
-                return;
+                break;
             }
 
-            processBlock(block);
+            m_downloadStatus.storeBlockHash(block.blockHash, block.blockHeight);
+
+            QueuedBlock queued;
+
+            queued.generation = generation;
+            queued.block = std::make_shared<const wallet_types::WalletBlockInfo>(block);
+            queued.lastInBatch = &block == &blocks.back();
+
+            /* Start looking for our outputs straight away, on whichever
+               scan thread is free */
+            queued.ourInputs = m_scanPool->addJob([this, block = queued.block]
+                                                  { return processBlockOutputs(*block); })
+                                   .share();
+
+            /* Blocks whilst the queue is full, so we only ever get
+               MAXIMUM_SYNC_QUEUE_SIZE blocks ahead of the scanner */
+            m_blockQueue.push(queued);
         }
 
         if (blocks.empty() && !m_shouldStop)
@@ -124,7 +197,9 @@ std::vector<wallet_types::WalletBlockInfo> WalletSynchronizer::downloadBlocks()
 {
     const uint64_t localDaemonBlockCount = m_daemon->localDaemonBlockCount();
 
-    const uint64_t walletBlockCount = getCurrentScanHeight();
+    /* Where we've downloaded up to, not where we've scanned up to, since
+       those blocks are already queued */
+    const uint64_t walletBlockCount = m_downloadStatus.getHeight();
 
     /* Local daemon has less blocks than the wallet:
 
@@ -157,7 +232,7 @@ std::vector<wallet_types::WalletBlockInfo> WalletSynchronizer::downloadBlocks()
     }
 
     /* The block hashes to try begin syncing from */
-    const auto blockCheckpoints = m_syncStatus.getBlockHashCheckpoints();
+    const auto blockCheckpoints = m_downloadStatus.getBlockHashCheckpoints();
 
     /* Blocks the thread for up to 10 secs */
     const auto [success, blocks] = m_daemon->getWalletSyncData(
@@ -210,17 +285,21 @@ std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> Walle
 {
     std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> inputs;
 
+    /* Only changes when subwallets are added or removed, which can't happen
+       whilst we're syncing */
+    const auto spendKeys = m_subWallets->getPublicSpendKeySet();
+
     if (wallet_config::processCoinbaseTransactions)
     {
         const auto newInputs = processTransactionOutputs(
-            block.coinbaseTransaction, block.blockHeight);
+            block.coinbaseTransaction, block.blockHeight, *spendKeys);
 
         inputs.insert(inputs.end(), newInputs.begin(), newInputs.end());
     }
 
-    for (const auto tx : block.transactions)
+    for (const auto &tx : block.transactions)
     {
-        const auto newInputs = processTransactionOutputs(tx, block.blockHeight);
+        const auto newInputs = processTransactionOutputs(tx, block.blockHeight, *spendKeys);
 
         inputs.insert(inputs.end(), newInputs.begin(), newInputs.end());
     }
@@ -228,7 +307,9 @@ std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> Walle
     return inputs;
 }
 
-void WalletSynchronizer::processBlock(const wallet_types::WalletBlockInfo &block)
+bool WalletSynchronizer::processBlock(
+    const wallet_types::WalletBlockInfo &block,
+    std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> ourInputs)
 {
     /* Chain forked, invalidate previous transactions */
     if (m_syncStatus.getHeight() >= block.blockHeight)
@@ -236,8 +317,6 @@ void WalletSynchronizer::processBlock(const wallet_types::WalletBlockInfo &block
         removeForkedTransactions(block.blockHeight);
     }
 
-    auto ourInputs = processBlockOutputs(block);
-
     std::unordered_map<crypto::Hash, std::vector<uint64_t>> globalIndexes;
 
     for (auto &[publicKey, input] : ourInputs)
@@ -263,7 +342,7 @@ void WalletSynchronizer::processBlock(const wallet_types::WalletBlockInfo &block
                 std::cout << "Warning: Failed to get correct global indexes from daemon."
                           << "\nIf you see this error message repeatedly, the daemon "
                           << "may be faulty. More likely, the chain just forked.\n";
-                return;
+                return false;
             }
 
             input.globalOutputIndex = it->second[input.transactionIndex];
@@ -272,20 +351,20 @@ void WalletSynchronizer::processBlock(const wallet_types::WalletBlockInfo &block
 
     BlockScanTmpInfo blockScanInfo = processBlockTransactions(block, ourInputs);
 
-    for (const auto tx : blockScanInfo.transactionsToAdd)
+    for (const auto &tx : blockScanInfo.transactionsToAdd)
     {
         m_subWallets->addTransaction(tx);
         m_eventHandler->onTransaction.fire(tx);
     }
 
-    for (const auto [publicKey, input] : blockScanInfo.inputsToAdd)
+    for (const auto &[publicKey, input] : blockScanInfo.inputsToAdd)
     {
         m_subWallets->storeTransactionInput(publicKey, input);
     }
 
     /* The input has been spent, discard the key image so we
        don't double spend it */
-    for (const auto [publicKey, keyImage] : blockScanInfo.keyImagesToMarkSpent)
+    for (const auto &[publicKey, keyImage] : blockScanInfo.keyImagesToMarkSpent)
     {
         m_subWallets->markInputAsSpent(keyImage, publicKey, block.blockHeight);
     }
@@ -299,6 +378,26 @@ void WalletSynchronizer::processBlock(const wallet_types::WalletBlockInfo &block
     {
         m_eventHandler->onSynced.fire(block.blockHeight);
     }
+
+    return true;
+}
+
+void WalletSynchronizer::updateSyncSpeed()
+{
+    std::scoped_lock lock(m_syncSpeedMutex);
+
+    m_blocksScannedInWindow++;
+
+    const auto now = std::chrono::steady_clock::now();
+
+    const double elapsed = std::chrono::duration<double>(now - m_syncSpeedWindowStart).count();
+
+    if (elapsed >= Constants::SYNC_SPEED_WINDOW_SECONDS)
+    {
+        m_syncSpeed = m_blocksScannedInWindow / elapsed;
+        m_blocksScannedInWindow = 0;
+        m_syncSpeedWindowStart = now;
+    }
 }
 
 BlockScanTmpInfo WalletSynchronizer::processBlockTransactions(
@@ -317,7 +416,7 @@ BlockScanTmpInfo WalletSynchronizer::processBlockTransactions(
         }
     }
 
-    for (const auto rawTX : block.transactions)
+    for (const auto &rawTX : block.transactions)
     {
         const auto [tx, keyImagesToMarkSpent] = processTransaction(
             block, inputs, rawTX);
@@ -342,13 +441,13 @@ std::optional<wallet_types::Transaction> WalletSynchronizer::processCoinbaseTran
     const wallet_types::WalletBlockInfo &block,
     const std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> &inputs) const
 {
-    const auto tx = block.coinbaseTransaction;
+    const auto &tx = block.coinbaseTransaction;
 
     std::unordered_map<crypto::PublicKey, int64_t> transfers;
 
     std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> relevantInputs;
 
-    std::copy_if(inputs.begin(), inputs.end(), std::back_inserter(relevantInputs), [&](const auto input)
+    std::copy_if(inputs.begin(), inputs.end(), std::back_inserter(relevantInputs), [&](const auto &input)
                  { return std::get<1>(input).parentTransactionHash == tx.hash; });
 
     for (const auto &[publicSpendKey, input] : relevantInputs)
@@ -379,7 +478,7 @@ std::tuple<std::optional<wallet_types::Transaction>, std::vector<std::tuple<cryp
 
     std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> relevantInputs;
 
-    std::copy_if(inputs.begin(), inputs.end(), std::back_inserter(relevantInputs), [&](const auto input)
+    std::copy_if(inputs.begin(), inputs.end(), std::back_inserter(relevantInputs), [&](const auto &input)
                  { return std::get<1>(input).parentTransactionHash == tx.hash; });
 
     for (const auto &[publicSpendKey, input] : relevantInputs)
@@ -389,7 +488,7 @@ std::tuple<std::optional<wallet_types::Transaction>, std::vector<std::tuple<cryp
 
     std::vector<std::tuple<crypto::PublicKey, crypto::KeyImage>> spentKeyImages;
 
-    for (const auto input : tx.keyInputs)
+    for (const auto &input : tx.keyInputs)
     {
         const auto [found, publicSpendKey] = m_subWallets->getKeyImageOwner(
             input.keyImage);
@@ -405,12 +504,12 @@ std::tuple<std::optional<wallet_types::Transaction>, std::vector<std::tuple<cryp
     {
         uint64_t fee = 0;
 
-        for (const auto input : tx.keyInputs)
+        for (const auto &input : tx.keyInputs)
         {
             fee += input.amount;
         }
 
-        for (const auto output : tx.keyOutputs)
+        for (const auto &output : tx.keyOutputs)
         {
             fee -= output.amount;
         }
@@ -429,7 +528,8 @@ std::tuple<std::optional<wallet_types::Transaction>, std::vector<std::tuple<cryp
 
 std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> WalletSynchronizer::processTransactionOutputs(
     const wallet_types::RawCoinbaseTransaction &rawTX,
-    const uint64_t blockHeight) const
+    const uint64_t blockHeight,
+    const std::unordered_set<crypto::PublicKey> &spendKeys) const
 {
     std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> inputs;
 
@@ -437,22 +537,17 @@ std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> Walle
 
     crypto::generate_key_derivation(rawTX.transactionPublicKey, m_privateViewKey, derivation);
 
-    const std::vector<crypto::PublicKey> spendKeys = m_subWallets->m_publicSpendKeys;
-
     uint64_t outputIndex = 0;
 
-    for (const auto output : rawTX.keyOutputs)
+    for (const auto &output : rawTX.keyOutputs)
     {
         crypto::PublicKey derivedSpendKey;
 
         crypto::underive_public_key(derivation, outputIndex, output.key, derivedSpendKey);
 
-        /* See if the derived spend key matches any of our spend keys */
-        const auto ourSpendKey = std::find(spendKeys.begin(), spendKeys.end(),
-                                           derivedSpendKey);
-
-        /* If it does, the transaction belongs to us */
-        if (ourSpendKey != spendKeys.end())
+        /* If the derived spend key matches any of our spend keys, the
+           transaction belongs to us */
+        if (spendKeys.find(derivedSpendKey) != spendKeys.end())
         {
             /* We need to fill in the key image of the transaction input -
                we'll let the subwallet do this since we need the private spend
@@ -554,7 +649,24 @@ void WalletSynchronizer::start()
         throw std::runtime_error("Daemon has not been initialized!");
     }
 
+    /* Pick up downloading from where we scanned up to, anything still
+       queued from before we were stopped is out of date */
+    m_downloadStatus = m_syncStatus;
+    m_downloadGeneration++;
+    m_blockQueue.start();
+
+    m_scanPool = std::make_unique<common::ThreadPool>(m_scanThreadCount);
+
+    {
+        std::scoped_lock lock(m_syncSpeedMutex);
+
+        m_syncSpeedWindowStart = std::chrono::steady_clock::now();
+        m_blocksScannedInWindow = 0;
+        m_syncSpeed = 0;
+    }
+
     m_syncThread = std::thread(&WalletSynchronizer::mainLoop, this);
+    m_downloadThread = std::thread(&WalletSynchronizer::downloaderLoop, this);
 }
 
 void WalletSynchronizer::stop()
@@ -562,11 +674,28 @@ void WalletSynchronizer::stop()
     /* Tell the threads to stop */
     m_shouldStop = true;
 
-    /* Wait for the block downloader thread to finish (if applicable) */
+    /* Wake up anything waiting on the block queue */
+    m_blockQueue.stop();
+
+    /* Wait for the block scanner thread to finish (if applicable) */
     if (m_syncThread.joinable())
     {
         m_syncThread.join();
     }
+
+    /* Wait for the block downloader thread to finish (if applicable) */
+    if (m_downloadThread.joinable())
+    {
+        m_downloadThread.join();
+    }
+
+    /* Finishes off any blocks still being scanned */
+    m_scanPool.reset();
+}
+
+void WalletSynchronizer::setScanThreadCount(const size_t threadCount)
+{
+    m_scanThreadCount = threadCount;
 }
 
 void WalletSynchronizer::reset(uint64_t startHeight)
@@ -602,6 +731,23 @@ uint64_t WalletSynchronizer::getCurrentScanHeight() const
     return m_syncStatus.getHeight();
 }
 
+double WalletSynchronizer::getSyncSpeed() const
+{
+    std::scoped_lock lock(m_syncSpeedMutex);
+
+    const double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - m_syncSpeedWindowStart).count();
+
+    /* Not scanned enough to finish the window, so the speed is falling -
+       report it from what we have scanned so far */
+    if (elapsed >= Constants::SYNC_SPEED_WINDOW_SECONDS)
+    {
+        return m_blocksScannedInWindow / elapsed;
+    }
+
+    return m_syncSpeed;
+}
+
 void WalletSynchronizer::swapNode(const std::shared_ptr<Nigel> daemon)
 {
     m_daemon = daemon;
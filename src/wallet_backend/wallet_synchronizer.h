@@ -5,8 +5,18 @@
 
 #pragma once
 
+#include <atomic>
+
+#include <chrono>
+
 #include <memory>
 
+#include <mutex>
+
+#include <thread>
+
+#include <common/thread_pool.h>
+
 #include <nigel/nigel.h>
 
 #include <sub_wallets/sub_wallets.h>
@@ -33,6 +43,24 @@ struct BlockScanTmpInfo
     std::vector<std::tuple<crypto::PublicKey, crypto::KeyImage>> keyImagesToMarkSpent;
 };
 
+/* A downloaded block, waiting to be scanned */
+struct QueuedBlock
+{
+    /* The download generation the block belongs to */
+    uint64_t generation = 0;
+
+    std::shared_ptr<const wallet_types::WalletBlockInfo> block;
+
+    /* The outputs in the block that belong to us. These are found on the
+       scan thread pool as soon as the block is downloaded, and picked up
+       by the scanner thread in block order. */
+    std::shared_future<std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>>> ourInputs;
+
+    /* The last block of the batch it was downloaded in. Once it's processed
+       the scanner publishes the wallet state for readers. */
+    bool lastInBatch = false;
+};
+
 class WalletSynchronizer
 {
 public:
@@ -88,10 +116,18 @@ public:
 
     uint64_t getCurrentScanHeight() const;
 
+    /* Blocks scanned per second, over roughly the last
+       SYNC_SPEED_WINDOW_SECONDS seconds */
+    double getSyncSpeed() const;
+
     void swapNode(const std::shared_ptr<Nigel> daemon);
 
     void setSyncStart(const uint64_t startTimestamp, const uint64_t startHeight);
 
+    /* The number of threads used to find our outputs in downloaded blocks.
+       Takes effect the next time the synchronizer is started. */
+    void setScanThreadCount(const size_t threadCount);
+
     /////////////////////////////
     /* Public member variables */
     /////////////////////////////
@@ -104,14 +140,25 @@ private:
     /* Private member functions */
     //////////////////////////////
 
+    /* Scans the blocks the downloader queued up */
     void mainLoop();
 
+    /* Keeps the block queue topped up, so we aren't waiting on the network
+       whilst scanning */
+    void downloaderLoop();
+
     std::vector<wallet_types::WalletBlockInfo> downloadBlocks();
 
     std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> processBlockOutputs(
         const wallet_types::WalletBlockInfo &block) const;
 
-    void processBlock(const wallet_types::WalletBlockInfo &block);
+    /* Returns false if the block couldn't be processed, and needs to be
+       downloaded again */
+    bool processBlock(
+        const wallet_types::WalletBlockInfo &block,
+        std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> ourInputs);
+
+    void updateSyncSpeed();
 
     BlockScanTmpInfo processBlockTransactions(
         const wallet_types::WalletBlockInfo &block,
@@ -128,7 +175,8 @@ private:
 
     std::vector<std::tuple<crypto::PublicKey, wallet_types::TransactionInput>> processTransactionOutputs(
         const wallet_types::RawCoinbaseTransaction &rawTX,
-        const uint64_t blockHeight) const;
+        const uint64_t blockHeight,
+        const std::unordered_set<crypto::PublicKey> &spendKeys) const;
 
     std::unordered_map<crypto::Hash, std::vector<uint64_t>> getGlobalIndexes(
         const uint64_t blockHeight) const;
@@ -141,14 +189,52 @@ private:
     /* Private member variables */
     //////////////////////////////
 
-    /* The thread ID of the block downloader thread */
+    /* The thread ID of the block scanner thread */
     std::thread m_syncThread;
 
-    /* An atomic bool to signal if we should stop the sync thread */
+    /* The thread ID of the block downloader thread */
+    std::thread m_downloadThread;
+
+    /* An atomic bool to signal if we should stop the sync threads */
     std::atomic<bool> m_shouldStop;
 
+    /* Where we have scanned up to */
     SynchronizationStatus m_syncStatus;
 
+    /* Where the downloader has got up to. This is ahead of m_syncStatus
+       by however many blocks are queued. Only used by the downloader
+       thread once started. */
+    SynchronizationStatus m_downloadStatus;
+
+    /* Blocks that have been downloaded but not scanned yet */
+    ThreadSafeQueue<QueuedBlock> m_blockQueue;
+
+    /* Bumped when the queued blocks can no longer be used, for example
+       when a block fails to process. The downloader then starts again
+       from the last scanned block, and the scanner skips anything queued
+       from an earlier generation. */
+    std::atomic<uint64_t> m_downloadGeneration;
+
+    /* Used to calculate the sync speed */
+    mutable std::mutex m_syncSpeedMutex;
+
+    /* When the current sync speed window began */
+    std::chrono::steady_clock::time_point m_syncSpeedWindowStart;
+
+    /* Blocks scanned since m_syncSpeedWindowStart */
+    uint64_t m_blocksScannedInWindow = 0;
+
+    /* Blocks per second in the last complete window */
+    double m_syncSpeed = 0;
+
+    /* The number of threads in m_scanPool */
+    size_t m_scanThreadCount = std::thread::hardware_concurrency();
+
+    /* Finds our outputs in downloaded blocks. Only exists whilst the
+       synchronizer is running, so no scanning is left going on in the
+       background when it is stopped. */
+    std::unique_ptr<common::ThreadPool> m_scanPool;
+
     /* The timestamp to start scanning downloading block data from */
     uint64_t m_startTimestamp;
 
@@ -136,6 +136,27 @@ namespace payment_service
         serializer(addresses, "addresses");
     }
 
+    void CreateAddressListAsync::Response::serialize(mevacoin::ISerializer &serializer)
+    {
+        serializer(jobId, "jobId");
+    }
+
+    void GetCreateAddressListStatus::Request::serialize(mevacoin::ISerializer &serializer)
+    {
+        if (!serializer(jobId, "jobId"))
+        {
+            throw RequestSerializationError();
+        }
+    }
+
+    void GetCreateAddressListStatus::Response::serialize(mevacoin::ISerializer &serializer)
+    {
+        serializer(status, "status");
+        serializer(totalCount, "totalCount");
+        serializer(addresses, "addresses");
+        serializer(error, "error");
+    }
+
     void DeleteAddress::Request::serialize(mevacoin::ISerializer &serializer)
     {
         if (!serializer(address, "address"))
@@ -182,6 +182,43 @@ namespace payment_service
         };
     };
 
+    struct CreateAddressListAsync
+    {
+        typedef CreateAddressList::Request Request;
+
+        struct Response
+        {
+            uint64_t jobId;
+
+            void serialize(mevacoin::ISerializer &serializer);
+        };
+    };
+
+    struct GetCreateAddressListStatus
+    {
+        struct Request
+        {
+            uint64_t jobId;
+
+            void serialize(mevacoin::ISerializer &serializer);
+        };
+
+        struct Response
+        {
+            /* One of queued, running, finished or failed */
+            std::string status;
+
+            uint64_t totalCount;
+
+            /* The addresses created so far */
+            std::vector<std::string> addresses;
+
+            std::string error;
+
+            void serialize(mevacoin::ISerializer &serializer);
+        };
+    };
+
     struct DeleteAddress
     {
         struct Request
@@ -30,6 +30,8 @@ namespace payment_service
         handlers.emplace("reset", jsonHandler<Reset::Request, Reset::Response>(std::bind(&PaymentServiceJsonRpcServer::handleReset, this, std::placeholders::_1, std::placeholders::_2)));
         handlers.emplace("createAddress", jsonHandler<CreateAddress::Request, CreateAddress::Response>(std::bind(&PaymentServiceJsonRpcServer::handleCreateAddress, this, std::placeholders::_1, std::placeholders::_2)));
         handlers.emplace("createAddressList", jsonHandler<CreateAddressList::Request, CreateAddressList::Response>(std::bind(&PaymentServiceJsonRpcServer::handleCreateAddressList, this, std::placeholders::_1, std::placeholders::_2)));
+        handlers.emplace("createAddressListAsync", jsonHandler<CreateAddressListAsync::Request, CreateAddressListAsync::Response>(std::bind(&PaymentServiceJsonRpcServer::handleCreateAddressListAsync, this, std::placeholders::_1, std::placeholders::_2)));
+        handlers.emplace("getCreateAddressListStatus", jsonHandler<GetCreateAddressListStatus::Request, GetCreateAddressListStatus::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetCreateAddressListStatus, this, std::placeholders::_1, std::placeholders::_2)));
         handlers.emplace("deleteAddress", jsonHandler<DeleteAddress::Request, DeleteAddress::Response>(std::bind(&PaymentServiceJsonRpcServer::handleDeleteAddress, this, std::placeholders::_1, std::placeholders::_2)));
         handlers.emplace("getSpendKeys", jsonHandler<GetSpendKeys::Request, GetSpendKeys::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetSpendKeys, this, std::placeholders::_1, std::placeholders::_2)));
         handlers.emplace("getBalance", jsonHandler<GetBalance::Request, GetBalance::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetBalance, this, std::placeholders::_1, std::placeholders::_2)));
@@ -163,6 +165,16 @@ namespace payment_service
         return service.createAddressList(request.spendSecretKeys, request.scanHeight, request.newAddress, response.addresses);
     }
 
+    std::error_code PaymentServiceJsonRpcServer::handleCreateAddressListAsync(const CreateAddressListAsync::Request &request, CreateAddressListAsync::Response &response)
+    {
+        return service.createAddressListAsync(request.spendSecretKeys, request.scanHeight, request.newAddress, response.jobId);
+    }
+
+    std::error_code PaymentServiceJsonRpcServer::handleGetCreateAddressListStatus(const GetCreateAddressListStatus::Request &request, GetCreateAddressListStatus::Response &response)
+    {
+        return service.getCreateAddressListStatus(request.jobId, response);
+    }
+
     std::error_code PaymentServiceJsonRpcServer::handleDeleteAddress(const DeleteAddress::Request &request, DeleteAddress::Response &response)
     {
         return service.deleteAddress(request.address);
@@ -95,6 +95,8 @@ namespace payment_service
         std::error_code handleReset(const Reset::Request &request, Reset::Response &response);
         std::error_code handleCreateAddress(const CreateAddress::Request &request, CreateAddress::Response &response);
         std::error_code handleCreateAddressList(const CreateAddressList::Request &request, CreateAddressList::Response &response);
+        std::error_code handleCreateAddressListAsync(const CreateAddressListAsync::Request &request, CreateAddressListAsync::Response &response);
+        std::error_code handleGetCreateAddressListStatus(const GetCreateAddressListStatus::Request &request, GetCreateAddressListStatus::Response &response);
         std::error_code handleDeleteAddress(const DeleteAddress::Request &request, DeleteAddress::Response &response);
         std::error_code handleGetSpendKeys(const GetSpendKeys::Request &request, GetSpendKeys::Response &response);
         std::error_code handleGetBalance(const GetBalance::Request &request, GetBalance::Response &response);
@@ -511,7 +511,9 @@ namespace payment_service
                                                                                                                                                                                       logger(logger, "WalletService"),
                                                                                                                                                                                       dispatcher(sys),
                                                                                                                                                                                       readyEvent(dispatcher),
-                                                                                                                                                                                      refreshContext(dispatcher)
+                                                                                                                                                                                      refreshContext(dispatcher),
+                                                                                                                                                                                      createAddressListContext(dispatcher),
+                                                                                                                                                                                      nextCreateAddressListJobId(1)
     {
         readyEvent.set();
     }
@@ -520,6 +522,8 @@ namespace payment_service
     {
         if (inited)
         {
+            createAddressListContext.interrupt();
+            createAddressListContext.wait();
             wallet.stop();
             refreshContext.wait();
             wallet.shutdown();
@@ -719,26 +723,10 @@ namespace payment_service
             logger(logging::DEBUGGING) << "Creating " << spendSecretKeysText.size() << " addresses...";
 
             std::vector<crypto::SecretKey> secretKeys;
-            std::unordered_set<std::string> unique;
-            secretKeys.reserve(spendSecretKeysText.size());
-            unique.reserve(spendSecretKeysText.size());
-            for (auto &keyText : spendSecretKeysText)
-            {
-                auto insertResult = unique.insert(keyText);
-                if (!insertResult.second)
-                {
-                    logger(logging::WARNING, logging::BRIGHT_YELLOW) << "Not unique key";
-                    return make_error_code(mevacoin::error::WalletServiceErrorCode::DUPLICATE_KEY);
-                }
-
-                crypto::SecretKey key;
-                if (!common::podFromHex(keyText, key))
-                {
-                    logger(logging::WARNING, logging::BRIGHT_YELLOW) << "Wrong key format: " << keyText;
-                    return make_error_code(mevacoin::error::WalletServiceErrorCode::WRONG_KEY_FORMAT);
-                }
 
-                secretKeys.push_back(std::move(key));
+            if (auto error = parseSpendSecretKeys(spendSecretKeysText, secretKeys))
+            {
+                return error;
             }
 
             addresses = wallet.createAddressList(secretKeys, scanHeight, newAddress);
@@ -754,6 +742,165 @@ namespace payment_service
         return std::error_code();
     }
 
+    std::error_code WalletService::createAddressListAsync(const std::vector<std::string> &spendSecretKeysText, uint64_t scanHeight, bool newAddress, uint64_t &jobId)
+    {
+        CreateAddressListJob job;
+
+        /* Bad keys are reported straight away, rather than failing the job */
+        if (auto error = parseSpendSecretKeys(spendSecretKeysText, job.spendSecretKeys))
+        {
+            return error;
+        }
+
+        job.scanHeight = scanHeight;
+        job.newAddress = newAddress;
+        job.totalCount = job.spendSecretKeys.size();
+        job.status = "queued";
+
+        jobId = nextCreateAddressListJobId++;
+
+        createAddressListJobs.emplace(jobId, std::move(job));
+
+        createAddressListContext.spawn([this, jobId]
+                                       { runCreateAddressListJob(jobId); });
+
+        logger(logging::DEBUGGING) << "Queued creating " << spendSecretKeysText.size() << " addresses, job " << jobId;
+
+        return std::error_code();
+    }
+
+    std::error_code WalletService::getCreateAddressListStatus(const uint64_t jobId, GetCreateAddressListStatus::Response &status)
+    {
+        const auto it = createAddressListJobs.find(jobId);
+
+        if (it == createAddressListJobs.end())
+        {
+            logger(logging::WARNING, logging::BRIGHT_YELLOW) << "Create address list job not found: " << jobId;
+            return make_error_code(mevacoin::error::WalletServiceErrorCode::OBJECT_NOT_FOUND);
+        }
+
+        const CreateAddressListJob &job = it->second;
+
+        status.status = job.status;
+        status.totalCount = job.totalCount;
+        status.addresses = job.addresses;
+        status.error = job.error;
+
+        /* The result has been handed over, so it isn't needed any more */
+        if (job.status == "finished" || job.status == "failed")
+        {
+            createAddressListJobs.erase(it);
+        }
+
+        return std::error_code();
+    }
+
+    void WalletService::runCreateAddressListJob(const uint64_t jobId)
+    {
+        /* Keys are added this many at a time, each batch in one container
+           transaction. The lock is given up between batches so other requests
+           aren't held up for the whole import. */
+        const size_t batchSize = 1000;
+
+        CreateAddressListJob &job = createAddressListJobs.at(jobId);
+
+        job.status = "running";
+
+        try
+        {
+            for (size_t start = 0; start < job.spendSecretKeys.size(); start += batchSize)
+            {
+                const size_t end = std::min(start + batchSize, job.spendSecretKeys.size());
+
+                const std::vector<crypto::SecretKey> batch(job.spendSecretKeys.begin() + start, job.spendSecretKeys.begin() + end);
+
+                syst::EventLock lk(readyEvent);
+
+                /* Only the first batch can lower the wallet creation height and
+                   trigger a rescan, which the wallet synchronizer then does in
+                   the background with the rest of the wallet */
+                const auto addresses = wallet.createAddressList(batch, job.scanHeight, job.newAddress);
+
+                job.addresses.insert(job.addresses.end(), addresses.begin(), addresses.end());
+            }
+
+            job.status = "finished";
+
+            logger(logging::DEBUGGING) << "Created " << job.addresses.size() << " addresses, job " << jobId;
+        }
+        catch (std::system_error &x)
+        {
+            job.status = "failed";
+            job.error = x.what();
+
+            logger(logging::WARNING, logging::BRIGHT_YELLOW) << "Error while creating addresses, job " << jobId << ": " << x.what();
+        }
+        catch (syst::InterruptedException &)
+        {
+            job.status = "failed";
+            job.error = "interrupted";
+        }
+        /* The dispatcher drops anything thrown out of a context, which would
+           leave the job running forever */
+        catch (const std::exception &x)
+        {
+            job.status = "failed";
+            job.error = x.what();
+
+            logger(logging::WARNING, logging::BRIGHT_YELLOW) << "Error while creating addresses, job " << jobId << ": " << x.what();
+        }
+
+        /* No need to keep the secret keys around once the job is done */
+        std::vector<crypto::SecretKey>().swap(job.spendSecretKeys);
+
+        /* Jobs are dropped once their result is fetched. Drop the oldest ones
+           nobody fetched, so they don't pile up. */
+        const size_t maxFinishedJobs = 100;
+
+        size_t finishedJobs = std::count_if(createAddressListJobs.begin(), createAddressListJobs.end(), [](const auto &job)
+                                            { return job.second.status == "finished" || job.second.status == "failed"; });
+
+        for (auto it = createAddressListJobs.begin(); it != createAddressListJobs.end() && finishedJobs > maxFinishedJobs;)
+        {
+            if (it->second.status == "finished" || it->second.status == "failed")
+            {
+                it = createAddressListJobs.erase(it);
+                finishedJobs--;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    std::error_code WalletService::parseSpendSecretKeys(const std::vector<std::string> &spendSecretKeysText, std::vector<crypto::SecretKey> &secretKeys)
+    {
+        std::unordered_set<std::string> unique;
+        secretKeys.reserve(spendSecretKeysText.size());
+        unique.reserve(spendSecretKeysText.size());
+        for (auto &keyText : spendSecretKeysText)
+        {
+            auto insertResult = unique.insert(keyText);
+            if (!insertResult.second)
+            {
+                logger(logging::WARNING, logging::BRIGHT_YELLOW) << "Not unique key";
+                return make_error_code(mevacoin::error::WalletServiceErrorCode::DUPLICATE_KEY);
+            }
+
+            crypto::SecretKey key;
+            if (!common::podFromHex(keyText, key))
+            {
+                logger(logging::WARNING, logging::BRIGHT_YELLOW) << "Wrong key format: " << keyText;
+                return make_error_code(mevacoin::error::WalletServiceErrorCode::WRONG_KEY_FORMAT);
+            }
+
+            secretKeys.push_back(std::move(key));
+        }
+
+        return std::error_code();
+    }
+
     std::error_code WalletService::createAddress(std::string &address)
     {
         try
@@ -61,6 +61,8 @@ namespace payment_service
         std::error_code resetWallet(const uint64_t scanHeight);
         std::error_code createAddress(const std::string &spendSecretKeyText, const uint64_t scanHeight, const bool newAddress, std::string &address);
         std::error_code createAddressList(const std::vector<std::string> &spendSecretKeysText, const uint64_t scanHeight, const bool newAddress, std::vector<std::string> &addresses);
+        std::error_code createAddressListAsync(const std::vector<std::string> &spendSecretKeysText, const uint64_t scanHeight, const bool newAddress, uint64_t &jobId);
+        std::error_code getCreateAddressListStatus(const uint64_t jobId, GetCreateAddressListStatus::Response &status);
         std::error_code createAddress(std::string &address);
         std::error_code createTrackingAddress(const std::string &spendPublicKeyText, uint64_t scanHeight, bool newAddress, std::string &address);
         std::error_code deleteAddress(const std::string &address);
@@ -96,7 +98,22 @@ namespace payment_service
         std::error_code validateAddress(const std::string &address, bool &isValid);
 
     private:
+        /* A bulk address import started with createAddressListAsync */
+        struct CreateAddressListJob
+        {
+            std::vector<crypto::SecretKey> spendSecretKeys;
+            uint64_t scanHeight;
+            bool newAddress;
+
+            size_t totalCount;
+            std::string status;
+            std::vector<std::string> addresses;
+            std::string error;
+        };
+
         void refresh();
+        void runCreateAddressListJob(const uint64_t jobId);
+        std::error_code parseSpendSecretKeys(const std::vector<std::string> &spendSecretKeysText, std::vector<crypto::SecretKey> &secretKeys);
         void reset(const uint64_t scanHeight);
 
         void loadWallet();
@@ -122,10 +139,15 @@ namespace payment_service
         syst::Dispatcher &dispatcher;
         syst::Event readyEvent;
         syst::ContextGroup refreshContext;
+        syst::ContextGroup createAddressListContext;
         std::string m_node_address;
         uint32_t m_node_fee;
 
         std::map<std::string, size_t> transactionIdIndex;
+
+        /* Finished jobs are kept until their status is fetched, up to 100 */
+        std::map<uint64_t, CreateAddressListJob> createAddressListJobs;
+        uint64_t nextCreateAddressListJobId;
     };
 
 } // namespace payment_service
@@ -118,7 +118,7 @@ void balance(const std::shared_ptr<WalletBackend> walletBackend)
                                     "inflated.\n");
     }
 
-    const auto [walletBlockCount, localDaemonBlockCount, networkBlockCount] = walletBackend->getSyncStatus();
+    const auto [walletBlockCount, localDaemonBlockCount, networkBlockCount, syncSpeed] = walletBackend->getSyncStatus();
 
     if (localDaemonBlockCount < networkBlockCount)
     {
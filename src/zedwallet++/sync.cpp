@@ -20,7 +20,7 @@
 
 void syncWallet(const std::shared_ptr<WalletBackend> walletBackend)
 {
-    auto [walletBlockCount, localDaemonBlockCount, networkBlockCount] = walletBackend->getSyncStatus();
+    auto [walletBlockCount, localDaemonBlockCount, networkBlockCount, syncSpeed] = walletBackend->getSyncStatus();
 
     /* Fully synced */
     if (walletBlockCount == networkBlockCount)
@@ -65,10 +65,11 @@ void syncWallet(const std::shared_ptr<WalletBackend> walletBackend)
 
     while (walletBlockCount < localDaemonBlockCount)
     {
-        auto [tmpWalletBlockCount, localDaemonBlockCount, networkBlockCount] = walletBackend->getSyncStatus();
+        auto [tmpWalletBlockCount, localDaemonBlockCount, networkBlockCount, syncSpeed] = walletBackend->getSyncStatus();
 
         std::cout << SuccessMsg(tmpWalletBlockCount) << " of "
-                  << InformationMsg(localDaemonBlockCount) << std::endl;
+                  << InformationMsg(localDaemonBlockCount) << " ("
+                  << static_cast<uint64_t>(syncSpeed) << " blocks/s)" << std::endl;
 
         if (walletBlockCount == tmpWalletBlockCount)
         {